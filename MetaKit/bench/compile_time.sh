@@ -0,0 +1,53 @@
+#!/bin/sh
+# Measures the compile time of the compile-time benchmark TUs.
+#
+# Usage: bench/compile_time.sh [compiler...]   (defaults to g++ and clang++ when found)
+#
+# Each benchmark TU is compiled with -fsyntax-only, once per variant, and the best
+# wall-clock time of $RUNS runs is reported.
+
+set -eu
+
+here=$(cd "$(dirname "$0")" && pwd)
+lib="$here/../lib"
+runs=${RUNS:-3}
+
+compilers="$*"
+if [ -z "$compilers" ]; then
+    for cxx in g++ clang++; do
+        command -v "$cxx" >/dev/null 2>&1 && compilers="$compilers $cxx"
+    done
+fi
+
+# best_of <command...>: prints the best wall-clock time in milliseconds.
+best_of() {
+    best=""
+    i=0
+    while [ "$i" -lt "$runs" ]; do
+        start=$(date +%s%N)
+        "$@" >/dev/null
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then best=$ms; fi
+        i=$((i + 1))
+    done
+    echo "$best"
+}
+
+# bench <compiler> <name> <source> <flags...>
+bench() {
+    cxx=$1; name=$2; src=$3; shift 3
+    ms=$(best_of "$cxx" -std=c++20 -fsyntax-only -ftemplate-depth=2000 -I"$lib" "$@" "$here/$src")
+    printf '%-10s %-40s %8s ms\n' "$cxx" "$name" "$ms"
+}
+
+for cxx in $compilers; do
+    for length in 64 256 700; do
+        bench "$cxx" "type_list ops, indexed (n=$length)" compile_type_list.cpp -DMETAKIT_BENCH_LENGTH=$length
+        bench "$cxx" "type_list ops, naive recursion (n=$length)" compile_type_list.cpp -DMETAKIT_BENCH_LENGTH=$length -DMETAKIT_BENCH_NAIVE
+    done
+    for length in 500 2000; do
+        bench "$cxx" "traits, builtins (n=$length)" compile_traits.cpp -DMETAKIT_BENCH_LENGTH=$length
+        bench "$cxx" "traits, portable fallbacks (n=$length)" compile_traits.cpp -DMETAKIT_BENCH_LENGTH=$length "-DMETAKIT_HAS_BUILTIN(x)=0"
+    done
+done
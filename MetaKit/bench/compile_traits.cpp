@@ -0,0 +1,47 @@
+// Compile-time benchmark for the helper_.h type traits.
+//
+// Queries is_same_v, remove_cvref_t, is_integral_v, is_trivially_copyable_v, is_empty_v and
+// is_base_of_v for METAKIT_BENCH_LENGTH distinct types in several qualified forms. Build with
+// -D'METAKIT_HAS_BUILTIN(x)=0' to measure the portable fallbacks; compile_time.sh compares both.
+
+#include "helper_.h"
+
+#ifndef METAKIT_BENCH_LENGTH
+#define METAKIT_BENCH_LENGTH 2000
+#endif
+
+namespace bench
+{
+    using namespace metakit;
+
+    struct base {};
+
+    template <size_t>
+    struct t : base {};
+
+    template <typename T>
+    constexpr size_t score =
+        size_t(is_same_v<remove_cvref_t<T>, T>) +
+        size_t(is_same_v<remove_cvref_t<const T&>, T>) +
+        size_t(is_same_v<remove_cvref_t<volatile T&&>, T>) +
+        size_t(is_integral_v<T>) +
+        size_t(is_integral_v<const T&>) +
+        size_t(is_trivially_copyable_v<T>) +
+        size_t(is_empty_v<T>) +
+        size_t(is_base_of_v<base, T>);
+
+    template <size_t... indices>
+    constexpr size_t total(index_sequence<indices...>)
+    {
+        constexpr size_t scores[] = { score<t<indices>>..., score<t<indices>*>... };
+        size_t sum = 0;
+        for (size_t s : scores)
+            sum += s;
+        return sum;
+    }
+
+    static_assert(total(make_index_sequence<METAKIT_BENCH_LENGTH>{}) ==
+        6 * METAKIT_BENCH_LENGTH + 4 * METAKIT_BENCH_LENGTH);
+}
+
+int main() {}
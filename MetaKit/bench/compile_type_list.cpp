@@ -0,0 +1,85 @@
+// Compile-time benchmark for the structural type_list operations.
+//
+// Instantiates reverse, slice, insert_at, erase_at, rotate and chunk on a list of
+// METAKIT_BENCH_LENGTH distinct types. Build with -DMETAKIT_BENCH_NAIVE to use the
+// textbook recursive formulations instead; compile_time.sh compares the two.
+
+#include "type_list.h"
+
+#ifndef METAKIT_BENCH_LENGTH
+#define METAKIT_BENCH_LENGTH 256
+#endif
+
+namespace bench
+{
+    using namespace metakit;
+
+    template <size_t>
+    struct t {};
+
+    template <typename indices>
+    struct make_types;
+
+    template <size_t... indices>
+    struct make_types<index_sequence<indices...>> : has_type<type_list<t<indices>...>> {};
+
+    constexpr size_t n = METAKIT_BENCH_LENGTH;
+    using types = typename make_types<make_index_sequence<n>>::type;
+
+#ifdef METAKIT_BENCH_NAIVE
+    template <typename list, typename out = type_list<>>
+    struct naive_reverse : has_type<out> {};
+
+    template <typename T, typename... Ts, typename... Os>
+    struct naive_reverse<type_list<T, Ts...>, type_list<Os...>> : naive_reverse<type_list<Ts...>, type_list<T, Os...>> {};
+
+    template <typename list, size_t count, typename out = type_list<>>
+    struct naive_take : has_type<out> {};
+
+    template <typename T, typename... Ts, size_t count, typename... Os>
+    requires(count > 0)
+    struct naive_take<type_list<T, Ts...>, count, type_list<Os...>> : naive_take<type_list<Ts...>, count - 1, type_list<Os..., T>> {};
+
+    template <typename list, size_t count>
+    struct naive_drop : has_type<list> {};
+
+    template <typename T, typename... Ts, size_t count>
+    requires(count > 0)
+    struct naive_drop<type_list<T, Ts...>, count> : naive_drop<type_list<Ts...>, count - 1> {};
+
+    template <typename list, size_t begin, size_t end>
+    using naive_slice_t = typename naive_take<typename naive_drop<list, begin>::type, end - begin>::type;
+
+    template <typename list, size_t count>
+    struct naive_chunk : has_type<type_list<>> {};
+
+    template <typename... Ts, size_t count>
+    requires(sizeof...(Ts) > 0)
+    struct naive_chunk<type_list<Ts...>, count>
+        : has_type<concat_t<type_list<typename naive_take<type_list<Ts...>, count>::type>,
+            typename naive_chunk<typename naive_drop<type_list<Ts...>, count>::type, count>::type>> {};
+
+    using reversed = typename naive_reverse<types>::type;
+    using sliced = naive_slice_t<types, n / 4, 3 * n / 4>;
+    using inserted = concat_t<naive_slice_t<types, 0, n / 2>, type_list<int>, naive_slice_t<types, n / 2, n>>;
+    using erased = concat_t<naive_slice_t<types, 0, n / 2>, naive_slice_t<types, n / 2 + 1, n>>;
+    using rotated = concat_t<naive_slice_t<types, n / 3, n>, naive_slice_t<types, 0, n / 3>>;
+    using chunked = typename naive_chunk<types, 16>::type;
+#else
+    using reversed = reverse_t<types>;
+    using sliced = slice_t<types, n / 4, 3 * n / 4>;
+    using inserted = insert_at_t<types, n / 2, int>;
+    using erased = erase_at_t<types, n / 2>;
+    using rotated = rotate_t<types, n / 3>;
+    using chunked = chunk_t<types, 16>;
+#endif
+
+    static_assert(is_same_v<front_t<reversed>, t<n - 1>>);
+    static_assert(length_v<sliced> == n / 2);
+    static_assert(length_v<inserted> == n + 1);
+    static_assert(length_v<erased> == n - 1);
+    static_assert(is_same_v<front_t<rotated>, t<n / 3>>);
+    static_assert(length_v<chunked> == (n + 15) / 16);
+}
+
+int main() {}
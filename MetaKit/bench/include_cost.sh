@@ -0,0 +1,55 @@
+#!/bin/sh
+# Measures what including each library header costs a translation unit.
+#
+# Usage: bench/include_cost.sh [compiler...]   (defaults to g++ and clang++ when found)
+#
+# For every header in lib/ a TU containing only that #include is preprocessed (lines of
+# output) and compiled with -fsyntax-only (best wall-clock time of $RUNS runs). The first
+# row is an empty TU, i.e. the fixed cost of starting the compiler.
+
+set -eu
+
+here=$(cd "$(dirname "$0")" && pwd)
+lib="$here/../lib"
+runs=${RUNS:-5}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+compilers="$*"
+if [ -z "$compilers" ]; then
+    for cxx in g++ clang++; do
+        command -v "$cxx" >/dev/null 2>&1 && compilers="$compilers $cxx"
+    done
+fi
+
+# best_of <command...>: prints the best wall-clock time in milliseconds.
+best_of() {
+    best=""
+    i=0
+    while [ "$i" -lt "$runs" ]; do
+        start=$(date +%s%N)
+        "$@" >/dev/null
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then best=$ms; fi
+        i=$((i + 1))
+    done
+    echo "$best"
+}
+
+# measure <compiler> <label> <tu>
+measure() {
+    lines=$("$1" -std=c++20 -E -P -I"$lib" "$3" | wc -l)
+    ms=$(best_of "$1" -std=c++20 -fsyntax-only -I"$lib" "$3")
+    printf '%-10s %-18s %8s lines %6s ms\n' "$1" "$2" "$lines" "$ms"
+}
+
+for cxx in $compilers; do
+    : > "$tmp/empty.cpp"
+    measure "$cxx" "(empty TU)" "$tmp/empty.cpp"
+    for header in "$lib"/*.h; do
+        name=$(basename "$header")
+        printf '#include "%s"\n' "$name" > "$tmp/tu.cpp"
+        measure "$cxx" "$name" "$tmp/tu.cpp"
+    done
+done
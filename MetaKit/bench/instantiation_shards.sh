@@ -0,0 +1,122 @@
+#!/bin/sh
+# Measures the build time of a kernel instantiated for a large type list, with and without
+# explicit instantiation sharding (lib/instantiate.h, tools/instantiation_shards.py).
+#
+# Usage: bench/instantiation_shards.sh [compiler...]   (defaults to g++ and clang++ when found)
+#
+# The generated project has $USERS translation units that each run the kernel for all
+# $TYPES types. "implicit" lets every user TU instantiate the kernels itself; "sharded"
+# declares them extern and compiles the explicit instantiations in $SHARDS shard TUs.
+# Every TU is compiled once with -O2 and timed; "total" is the sum (the CPU time of the
+# build) and "critical path" is the slowest TU plus the link (the build time with one core
+# per TU).
+
+set -eu
+
+here=$(cd "$(dirname "$0")" && pwd)
+lib="$here/../lib"
+types=${TYPES:-500}
+users=${USERS:-4}
+shards=${SHARDS:-4}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+compilers="$*"
+if [ -z "$compilers" ]; then
+    for cxx in g++ clang++; do
+        command -v "$cxx" >/dev/null 2>&1 && compilers="$compilers $cxx"
+    done
+fi
+
+# The kernel: a few tuple operations per type, defined out of class so that the extern
+# template declarations suppress them.
+{
+    echo '#include "instantiate.h"'
+    echo '#include "tuple.h"'
+    echo
+    echo 'namespace bench {'
+    echo '    template <std::size_t i> struct t { int value = int(i); };'
+    echo '    template <typename T> struct is_t : metakit::false_type {};'
+    echo '    template <std::size_t i> struct is_t<t<i>> : metakit::true_type {};'
+    echo
+    echo '    template <typename T>'
+    echo '    struct kernel { static long run(const T& x); };'
+    echo
+    echo '    template <typename T>'
+    echo '    long kernel<T>::run(const T& x) {'
+    echo '        auto row = metakit::make_tuple(x, 1, 2.0, x);'
+    echo '        auto wide = metakit::tuple_cat(row, row, metakit::make_tuple(x, 3L));'
+    echo '        auto only_t = metakit::filter<is_t>(wide);'
+    echo '        return long(metakit::get<1>(wide) + metakit::get<2>(wide)) + metakit::get<0>(only_t).value;'
+    echo '    }'
+    echo '}'
+    echo
+    printf '#define BENCH_TYPES(X, arg)'
+    i=0
+    while [ "$i" -lt "$types" ]; do
+        printf ' \\\n    X(arg, bench::t<%d>)' "$i"
+        i=$((i + 1))
+    done
+    echo
+    echo
+    echo '#ifndef BENCH_IMPLICIT'
+    echo 'METAKIT_EXTERN_TEMPLATES(bench::kernel, BENCH_TYPES)'
+    echo '#endif'
+} > "$tmp/kernels.h"
+
+u=0
+while [ "$u" -lt "$users" ]; do
+    cat > "$tmp/user_$u.cpp" <<EOF
+#include "kernels.h"
+
+template <typename... Ts>
+static long run_all(metakit::type_list<Ts...>*) { return (bench::kernel<Ts>::run(Ts{}) + ...); }
+
+long user_$u() { return run_all(static_cast<METAKIT_TYPE_LIST(BENCH_TYPES)*>(nullptr)) + $u; }
+EOF
+    u=$((u + 1))
+done
+{
+    u=0
+    while [ "$u" -lt "$users" ]; do echo "long user_$u();"; u=$((u + 1)); done
+    printf 'int main() { return int(0'
+    u=0
+    while [ "$u" -lt "$users" ]; do printf ' + user_%d()' "$u"; u=$((u + 1)); done
+    echo ') & 1; }'
+} > "$tmp/main.cpp"
+
+python3 "$here/../tools/instantiation_shards.py" --header "$tmp/kernels.h" --list BENCH_TYPES \
+    --template bench::kernel --shards "$shards" --out "$tmp/shards"
+
+# ms <command...>: prints the wall-clock time of the command in milliseconds.
+ms() {
+    start=$(date +%s%N)
+    "$@"
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+# build <compiler> <name> <flags> <sources...>
+build() {
+    cxx=$1; name=$2; flags=$3; shift 3
+    total=0; slowest=0; objects=""
+    for src in "$@"; do
+        obj="$tmp/$(basename "$src" .cpp).o"
+        # shellcheck disable=SC2086
+        t=$(ms "$cxx" -std=c++20 -O2 -ftemplate-depth=2000 -I"$lib" -I"$tmp" $flags -c "$src" -o "$obj")
+        total=$((total + t))
+        if [ "$t" -gt "$slowest" ]; then slowest=$t; fi
+        objects="$objects $obj"
+    done
+    # shellcheck disable=SC2086
+    link=$(ms "$cxx" $objects -o "$tmp/a.out")
+    "$tmp/a.out" || true
+    printf '%-10s %-34s total %7s ms   critical path %6s ms (slowest TU %s + link %s)\n' \
+        "$cxx" "$name" "$((total + link))" "$((slowest + link))" "$slowest" "$link"
+    rm -f $objects
+}
+
+for cxx in $compilers; do
+    build "$cxx" "implicit ($users users)" -DBENCH_IMPLICIT "$tmp"/user_*.cpp "$tmp/main.cpp"
+    build "$cxx" "sharded ($users users, $shards shards)" "" "$tmp"/user_*.cpp "$tmp/main.cpp" "$tmp"/shards/*.cpp
+done
@@ -0,0 +1,319 @@
+#ifndef AUDIT_H
+#define AUDIT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <type_traits>
+#include <vector>
+
+#include "helper_.h"
+
+/**
+ * @brief Copy auditing of MetaKit's tuple operations.
+ *
+ * When `METAKIT_AUDIT_COPIES` is defined, every element a tuple operation constructs is
+ * counted as a copy or a move (reference elements are neither) and attributed to a call site:
+ *
+ * - `transform` and `filter` take a defaulted `std::source_location`, so each call is its own site;
+ * - `make_tuple`, `tuple_cat` and the element-wise constructor are variadic and cannot take
+ *   one; they count towards the innermost enclosing site, which can be an `audit_scope`
+ *   declared by the caller, and otherwise towards the operation itself.
+ *
+ * Counters live in per-thread tables written only by their thread, so recording is a plain
+ * relaxed load and store with no locked instruction. A thread's table is folded into the
+ * totals of finished threads and freed when the thread exits. `audit_report` and `audit_dump`
+ * read the tables of running threads and those totals, and merge them by site. Element types need no
+ * changes; without `METAKIT_AUDIT_COPIES` none of this is compiled into the operations.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief The copies and moves recorded for one call site, merged over all threads.
+     */
+    struct audit_entry
+    {
+        std::source_location site; ///< The call site.
+        std::uint64_t copies = 0;  ///< Elements copy-constructed by operations at this site.
+        std::uint64_t moves = 0;   ///< Elements move-constructed by operations at this site.
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief The counters of one thread, in a fixed-size open addressing table.
+         *
+         * Only the owning thread inserts and increments. A slot's site is written before `used`
+         * is published with release ordering, so readers that observe `used` see the site.
+         */
+        struct audit_table
+        {
+            static constexpr size_t capacity = 4096; ///< Sites per thread; further sites count as unattributed.
+
+            struct slot
+            {
+                std::atomic<bool> used{ false };
+                std::source_location site;
+                std::atomic<std::uint64_t> copies{ 0 };
+                std::atomic<std::uint64_t> moves{ 0 };
+            };
+
+            slot slots[capacity];
+            slot unattributed;          ///< Elements constructed outside any site, or with the table full.
+            audit_table* prev = nullptr; ///< The previous table in the registry.
+            audit_table* next = nullptr; ///< The next table in the registry.
+
+            slot& find(const std::source_location* site) noexcept
+            {
+                if (site == nullptr)
+                    return unattributed;
+
+                const std::uintptr_t hash = reinterpret_cast<std::uintptr_t>(site->file_name()) ^
+                    (std::uintptr_t(site->line()) * 0x9E3779B1u) ^ site->column();
+                for (size_t probe = 0; probe < capacity; ++probe)
+                {
+                    slot& s = slots[(hash + probe) % capacity];
+                    if (!s.used.load(std::memory_order_relaxed))
+                    {
+                        s.site = *site;
+                        s.used.store(true, std::memory_order_release);
+                        return s;
+                    }
+                    if (s.site.line() == site->line() && s.site.column() == site->column() &&
+                        s.site.file_name() == site->file_name())
+                        return s;
+                }
+                return unattributed;
+            }
+        };
+
+        /**
+         * @brief Adds counts to the entry of a site, creating it if needed.
+         */
+        inline void audit_merge(std::vector<audit_entry>& entries, const std::source_location& site, std::uint64_t copies, std::uint64_t moves)
+        {
+            if (copies == 0 && moves == 0)
+                return;
+            auto same_site = [&](const audit_entry& e)
+            {
+                return e.site.line() == site.line() && e.site.column() == site.column() &&
+                    std::strcmp(e.site.file_name(), site.file_name()) == 0 &&
+                    std::strcmp(e.site.function_name(), site.function_name()) == 0;
+            };
+            auto it = std::find_if(entries.begin(), entries.end(), same_site);
+            if (it == entries.end())
+                entries.push_back({ site, copies, moves });
+            else
+            {
+                it->copies += copies;
+                it->moves += moves;
+            }
+        }
+
+        /**
+         * @brief Merges the counts of a table into `entries`.
+         */
+        inline void audit_collect(const audit_table& t, std::vector<audit_entry>& entries)
+        {
+            for (const auto& s : t.slots)
+                if (s.used.load(std::memory_order_acquire))
+                    audit_merge(entries, s.site, s.copies.load(std::memory_order_relaxed), s.moves.load(std::memory_order_relaxed));
+            audit_merge(entries, std::source_location{}, t.unattributed.copies.load(std::memory_order_relaxed),
+                t.unattributed.moves.load(std::memory_order_relaxed));
+        }
+
+        inline std::mutex audit_registry_mutex;
+        inline audit_table* audit_tables = nullptr;   ///< The tables of running threads, guarded by the mutex.
+        inline std::vector<audit_entry> audit_retired; ///< The counts of finished threads, guarded by the mutex.
+
+        /**
+         * @brief Owns a thread's table: registers it on first use, and folds and frees it at thread exit.
+         */
+        struct audit_thread_table
+        {
+            audit_table* table = new audit_table;
+
+            audit_thread_table()
+            {
+                std::lock_guard lock(audit_registry_mutex);
+                table->next = audit_tables;
+                if (audit_tables)
+                    audit_tables->prev = table;
+                audit_tables = table;
+            }
+
+            ~audit_thread_table()
+            {
+                std::lock_guard lock(audit_registry_mutex);
+                audit_collect(*table, audit_retired);
+                (table->prev ? table->prev->next : audit_tables) = table->next;
+                if (table->next)
+                    table->next->prev = table->prev;
+                delete table;
+            }
+
+            audit_thread_table(const audit_thread_table&) = delete;
+            audit_thread_table& operator=(const audit_thread_table&) = delete;
+        };
+
+        /**
+         * @brief Retrieves the calling thread's table, registering it on first use.
+         */
+        inline audit_table& this_thread_audit_table()
+        {
+            thread_local audit_thread_table owner;
+            return *owner.table;
+        }
+
+        /**
+         * @brief The site that element constructions on this thread are attributed to.
+         */
+        inline thread_local const std::source_location* audit_current_site = nullptr;
+
+        /**
+         * @brief Makes a call site current for the lifetime of the object.
+         *
+         * Does nothing during constant evaluation, so that the audited operations stay `constexpr`.
+         */
+        class audit_site
+        {
+        public:
+            /**
+             * @param site The call site; must outlive the object.
+             * @param only_if_unset Leaves an enclosing site current instead of overriding it.
+             */
+            constexpr explicit audit_site(const std::source_location& site, bool only_if_unset = false) noexcept
+            {
+                if (std::is_constant_evaluated())
+                    return;
+                previous = audit_current_site;
+                if (!only_if_unset || previous == nullptr)
+                    audit_current_site = &site;
+            }
+
+            constexpr ~audit_site()
+            {
+                if (!std::is_constant_evaluated())
+                    audit_current_site = previous;
+            }
+
+            audit_site(const audit_site&) = delete;
+            audit_site& operator=(const audit_site&) = delete;
+
+        private:
+            const std::source_location* previous = nullptr;
+        };
+
+        /**
+         * @brief Adds one to a counter that only the calling thread writes.
+         */
+        inline void audit_increment(std::atomic<std::uint64_t>& counter) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Records the construction of a tuple element of type `Element` from an argument of type `Arg&&`.
+         */
+        template<typename Element, typename Arg>
+        void audit_element() noexcept
+        {
+            if constexpr (!is_lvalue_reference_v<Element> && !is_rvalue_reference_v<Element>)
+            {
+                audit_table::slot& s = this_thread_audit_table().find(audit_current_site);
+                if constexpr (is_lvalue_reference_v<Arg> || is_const_v<remove_refernce_t<Arg>>)
+                    audit_increment(s.copies);
+                else
+                    audit_increment(s.moves);
+            }
+        }
+    }//end of namespace detail
+
+    /**
+     * @brief Attributes the element copies and moves of the enclosed variadic operations to this line.
+     *
+     * Declare one next to a `make_tuple` or `tuple_cat` call to audit it as its own site.
+     */
+    class audit_scope
+    {
+    public:
+        explicit audit_scope(std::source_location where = std::source_location::current()) noexcept
+            : site(where), active(site) {}
+
+    private:
+        std::source_location site;
+        detail::audit_site active;
+    };
+
+    /**
+     * @brief Collects the counts of all threads, merged by call site and sorted by copies, then moves.
+     *
+     * Sites with neither copies nor moves are omitted. Element constructions outside any site
+     * appear as an entry with a default-constructed `site`.
+     */
+    inline std::vector<audit_entry> audit_report()
+    {
+        std::vector<audit_entry> entries;
+        {
+            std::lock_guard lock(detail::audit_registry_mutex);
+            entries = detail::audit_retired;
+            for (const auto* t = detail::audit_tables; t != nullptr; t = t->next)
+                detail::audit_collect(*t, entries);
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const audit_entry& a, const audit_entry& b)
+            {
+                return a.copies != b.copies ? a.copies > b.copies : a.moves > b.moves;
+            });
+        return entries;
+    }
+
+    /**
+     * @brief Writes `audit_report()` as a table, one call site per line.
+     */
+    inline void audit_dump(std::ostream& out)
+    {
+        out << "    copies      moves  site\n";
+        for (const audit_entry& e : audit_report())
+        {
+            out.width(10);
+            out << e.copies << ' ';
+            out.width(10);
+            out << e.moves << "  ";
+            if (e.site.line() == 0)
+                out << "(unattributed)\n";
+            else
+                out << e.site.file_name() << ':' << e.site.line() << ':' << e.site.column() << "  "
+                    << e.site.function_name() << '\n';
+        }
+    }
+
+    /**
+     * @brief Zeroes all counters.
+     *
+     * Only exact while no other thread performs audited operations, since their counters are
+     * not updated atomically with respect to the reset.
+     */
+    inline void audit_reset()
+    {
+        std::lock_guard lock(detail::audit_registry_mutex);
+        detail::audit_retired.clear();
+        for (auto* t = detail::audit_tables; t != nullptr; t = t->next)
+        {
+            for (auto& s : t->slots)
+            {
+                s.copies.store(0, std::memory_order_relaxed);
+                s.moves.store(0, std::memory_order_relaxed);
+            }
+            t->unattributed.copies.store(0, std::memory_order_relaxed);
+            t->unattributed.moves.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#endif
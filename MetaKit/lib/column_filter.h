@@ -0,0 +1,422 @@
+#ifndef COLUMN_FILTER_H
+#define COLUMN_FILTER_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "tuple.h"
+
+/**
+ * @brief Predicates evaluated over whole columns, producing bitmaps or selection vectors.
+ *
+ * A filter reads one contiguous column (see `scatter_to_columns`) and evaluates a comparison,
+ * an inclusive range or a set membership test on every element without a branch per row:
+ * - `filter_bitmap` sets bit `i % 64` of word `i / 64` for every selected row `i`;
+ * - `filter_selection` writes the indices of the selected rows, in increasing order;
+ * - `refine_selection` evaluates a second predicate only on the rows a first one selected,
+ *   and `bitmap_and` / `bitmap_or` combine bitmaps, for predicates on several fields;
+ * - `materialize` then builds tuples from the columns for the selected rows only.
+ *
+ * Columns of `float`, `double`, `std::int32_t` and `std::uint32_t` are compared four or two
+ * at a time with SSE2 on x86; other columns use a branch-free scalar loop.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief The comparison of a column element against a constant.
+     */
+    enum class compare : std::uint8_t
+    {
+        less,
+        less_equal,
+        greater,
+        greater_equal,
+        equal,
+        not_equal
+    };
+
+    /**
+     * @brief Selects the elements `x` for which `x op value` holds.
+     */
+    template<typename T>
+    struct compare_to
+    {
+        compare op;
+        T value;
+
+        constexpr bool operator()(const T& x) const noexcept
+        {
+            switch (op)
+            {
+            case compare::less: return x < value;
+            case compare::less_equal: return x <= value;
+            case compare::greater: return x > value;
+            case compare::greater_equal: return x >= value;
+            case compare::equal: return x == value;
+            default: return x != value;
+            }
+        }
+    };
+
+    /**
+     * @brief Selects the elements in `[low, high]`.
+     */
+    template<typename T>
+    struct in_range
+    {
+        T low;
+        T high;
+
+        constexpr bool operator()(const T& x) const noexcept { return low <= x && x <= high; }
+    };
+
+    /**
+     * @brief Selects the elements equal to one of `values`, which must be sorted in ascending order.
+     *
+     * Sets of up to `simd_limit` values are compared against every element; larger ones are binary searched.
+     */
+    template<typename T>
+    struct in_set
+    {
+        static constexpr size_t simd_limit = 16;
+
+        std::span<const T> values;
+
+        constexpr bool operator()(const T& x) const noexcept
+        {
+            const auto it = std::lower_bound(values.begin(), values.end(), x);
+            return it != values.end() && *it == x;
+        }
+    };
+
+    /**
+     * @brief The number of 64-bit words of a bitmap of `rows` rows.
+     */
+    constexpr size_t bitmap_words(size_t rows) noexcept { return (rows + 63) / 64; }
+
+    namespace detail
+    {
+        /**
+         * @brief SSE2 comparisons of the elements of one column type, unavailable by default.
+         */
+        template<typename T>
+        struct filter_lanes
+        {
+            static constexpr bool available = false;
+        };
+
+#if defined(__SSE2__) || defined(_M_X64)
+        template<>
+        struct filter_lanes<float>
+        {
+            static constexpr bool available = true;
+            static constexpr size_t width = 4;
+            using vector = __m128;
+
+            static vector load(const float* p) noexcept { return _mm_loadu_ps(p); }
+            static vector broadcast(float x) noexcept { return _mm_set1_ps(x); }
+            static vector any(vector a, vector b) noexcept { return _mm_or_ps(a, b); }
+            static unsigned bits(vector m) noexcept { return unsigned(_mm_movemask_ps(m)); }
+
+            template<compare op>
+            static vector mask(vector a, vector b) noexcept
+            {
+                if constexpr (op == compare::less) return _mm_cmplt_ps(a, b);
+                else if constexpr (op == compare::less_equal) return _mm_cmple_ps(a, b);
+                else if constexpr (op == compare::greater) return _mm_cmpgt_ps(a, b);
+                else if constexpr (op == compare::greater_equal) return _mm_cmpge_ps(a, b);
+                else if constexpr (op == compare::equal) return _mm_cmpeq_ps(a, b);
+                else return _mm_cmpneq_ps(a, b);
+            }
+        };
+
+        template<>
+        struct filter_lanes<double>
+        {
+            static constexpr bool available = true;
+            static constexpr size_t width = 2;
+            using vector = __m128d;
+
+            static vector load(const double* p) noexcept { return _mm_loadu_pd(p); }
+            static vector broadcast(double x) noexcept { return _mm_set1_pd(x); }
+            static vector any(vector a, vector b) noexcept { return _mm_or_pd(a, b); }
+            static unsigned bits(vector m) noexcept { return unsigned(_mm_movemask_pd(m)); }
+
+            template<compare op>
+            static vector mask(vector a, vector b) noexcept
+            {
+                if constexpr (op == compare::less) return _mm_cmplt_pd(a, b);
+                else if constexpr (op == compare::less_equal) return _mm_cmple_pd(a, b);
+                else if constexpr (op == compare::greater) return _mm_cmpgt_pd(a, b);
+                else if constexpr (op == compare::greater_equal) return _mm_cmpge_pd(a, b);
+                else if constexpr (op == compare::equal) return _mm_cmpeq_pd(a, b);
+                else return _mm_cmpneq_pd(a, b);
+            }
+        };
+
+        /**
+         * @brief 32-bit integers; unsigned ones are compared as signed after flipping their sign bits.
+         */
+        template<typename T>
+        struct integer_filter_lanes
+        {
+            static constexpr bool available = true;
+            static constexpr size_t width = 4;
+            using vector = __m128i;
+
+            static constexpr std::int32_t bias = std::is_signed_v<T> ? 0 : std::int32_t(0x80000000u);
+
+            static vector load(const T* p) noexcept
+            {
+                return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi32(bias));
+            }
+            static vector broadcast(T x) noexcept { return _mm_set1_epi32(std::int32_t(x) ^ bias); }
+            static vector any(vector a, vector b) noexcept { return _mm_or_si128(a, b); }
+            static unsigned bits(vector m) noexcept { return unsigned(_mm_movemask_ps(_mm_castsi128_ps(m))); }
+
+            template<compare op>
+            static vector mask(vector a, vector b) noexcept
+            {
+                const vector all = _mm_set1_epi32(-1);
+                if constexpr (op == compare::less) return _mm_cmplt_epi32(a, b);
+                else if constexpr (op == compare::less_equal) return _mm_xor_si128(_mm_cmpgt_epi32(a, b), all);
+                else if constexpr (op == compare::greater) return _mm_cmpgt_epi32(a, b);
+                else if constexpr (op == compare::greater_equal) return _mm_xor_si128(_mm_cmplt_epi32(a, b), all);
+                else if constexpr (op == compare::equal) return _mm_cmpeq_epi32(a, b);
+                else return _mm_xor_si128(_mm_cmpeq_epi32(a, b), all);
+            }
+        };
+
+        template<> struct filter_lanes<std::int32_t> : integer_filter_lanes<std::int32_t> {};
+        template<> struct filter_lanes<std::uint32_t> : integer_filter_lanes<std::uint32_t> {};
+#endif
+
+        /**
+         * @brief Calls `f` with the comparison as a compile-time constant, so that kernels have no switch per row.
+         */
+        template<typename F>
+        METAKIT_ALWAYS_INLINE decltype(auto) with_compare(compare op, F&& f)
+        {
+            switch (op)
+            {
+            case compare::less: return f(integral_constant<compare, compare::less>{});
+            case compare::less_equal: return f(integral_constant<compare, compare::less_equal>{});
+            case compare::greater: return f(integral_constant<compare, compare::greater>{});
+            case compare::greater_equal: return f(integral_constant<compare, compare::greater_equal>{});
+            case compare::equal: return f(integral_constant<compare, compare::equal>{});
+            default: return f(integral_constant<compare, compare::not_equal>{});
+            }
+        }
+
+        /**
+         * @brief Evaluates a predicate on 64 consecutive rows (or fewer at the end) into one bitmap word.
+         *
+         * `vector_mask(lanes_vector)` returns the selected lanes of one SIMD vector as bits, or is
+         * `nullptr` to evaluate every row with `scalar(x)`, which otherwise handles the rows past the
+         * last whole vector.
+         */
+        template<typename T, typename VectorMask, typename Scalar>
+        METAKIT_ALWAYS_INLINE std::uint64_t filter_word(const T* x, size_t n, const VectorMask& vector_mask, const Scalar& scalar) noexcept
+        {
+            std::uint64_t word = 0;
+            size_t i = 0;
+            if constexpr (filter_lanes<T>::available && !is_same_v<VectorMask, std::nullptr_t>)
+            {
+                using lanes = filter_lanes<T>;
+                for (; i + lanes::width <= n; i += lanes::width)
+                    word |= std::uint64_t(vector_mask(lanes::load(x + i))) << i;
+            }
+            for (; i < n; ++i)
+                word |= std::uint64_t(scalar(x[i])) << i;
+            return word;
+        }
+
+        /**
+         * @brief Calls `consume(word_index, word)` for every bitmap word of a predicate over a column.
+         */
+        template<typename T, typename Predicate, typename Consume>
+        void for_each_filter_word(std::span<const T> column, const Predicate& predicate, const Consume& consume)
+        {
+            const size_t n = column.size();
+            const T* x = column.data();
+            const auto run = [&](const auto& vector_mask, const auto& scalar)
+            {
+                for (size_t w = 0; w * 64 < n; ++w)
+                    consume(w, filter_word(x + w * 64, std::min<size_t>(64, n - w * 64), vector_mask, scalar));
+            };
+
+            if constexpr (!filter_lanes<T>::available)
+                run(nullptr, predicate);
+            else
+            {
+                using lanes = filter_lanes<T>;
+                using vector = typename lanes::vector;
+                if constexpr (is_same_v<Predicate, compare_to<T>>)
+                {
+                    with_compare(predicate.op, [&](auto op)
+                        {
+                            const vector value = lanes::broadcast(predicate.value);
+                            const compare_to<T> scalar{ op, predicate.value };
+                            run([&](vector v) { return lanes::bits(lanes::template mask<decltype(op)::value>(v, value)); },
+                                [&](const T& e) { return scalar(e); });
+                        });
+                }
+                else if constexpr (is_same_v<Predicate, in_range<T>>)
+                {
+                    const vector low = lanes::broadcast(predicate.low), high = lanes::broadcast(predicate.high);
+                    run([&](vector v)
+                        {
+                            return lanes::bits(lanes::template mask<compare::greater_equal>(v, low)) &
+                                lanes::bits(lanes::template mask<compare::less_equal>(v, high));
+                        }, predicate);
+                }
+                else if constexpr (is_same_v<Predicate, in_set<T>>)
+                {
+                    if (predicate.values.size() > in_set<T>::simd_limit || predicate.values.empty())
+                    {
+                        run(nullptr, predicate);
+                        return;
+                    }
+
+                    vector values[in_set<T>::simd_limit];
+                    const size_t count = predicate.values.size();
+                    for (size_t v = 0; v < count; ++v)
+                        values[v] = lanes::broadcast(predicate.values[v]);
+                    run([&](vector v)
+                        {
+                            vector found = lanes::template mask<compare::equal>(v, values[0]);
+                            for (size_t k = 1; k < count; ++k)
+                                found = lanes::any(found, lanes::template mask<compare::equal>(v, values[k]));
+                            return lanes::bits(found);
+                        },
+                        [&](const T& e) { return std::find(predicate.values.begin(), predicate.values.end(), e) != predicate.values.end(); });
+                }
+                else
+                    run(nullptr, predicate);
+            }
+        }
+    }//end of namespace detail
+
+    /**
+     * @brief Evaluates a predicate on every element of a column into a bitmap.
+     *
+     * @param bitmap At least `bitmap_words(column.size())` words; bits past the last row are cleared.
+     * @return The number of selected rows, or 0 if `bitmap` is too small.
+     */
+    template<typename T, typename Predicate>
+    size_t filter_bitmap(std::span<const T> column, const Predicate& predicate, std::span<std::uint64_t> bitmap)
+    {
+        if (bitmap.size() < bitmap_words(column.size()))
+            return 0;
+
+        size_t selected = 0;
+        detail::for_each_filter_word(column, predicate, [&](size_t w, std::uint64_t word)
+            {
+                bitmap[w] = word;
+                selected += size_t(std::popcount(word));
+            });
+        return selected;
+    }
+
+    /**
+     * @brief Writes the indices of the rows of a bitmap that are set, in increasing order.
+     *
+     * @param selection At least as many entries as set bits.
+     * @return The number of indices written.
+     */
+    inline size_t bitmap_to_selection(std::span<const std::uint64_t> bitmap, std::span<std::uint32_t> selection) noexcept
+    {
+        size_t n = 0;
+        for (size_t w = 0; w < bitmap.size(); ++w)
+            for (std::uint64_t word = bitmap[w]; word != 0; word &= word - 1)
+                selection[n++] = std::uint32_t(w * 64 + size_t(std::countr_zero(word)));
+        return n;
+    }
+
+    /**
+     * @brief Evaluates a predicate on every element of a column into a selection vector.
+     *
+     * @param selection At least `column.size()` entries.
+     * @return The number of selected rows, whose indices are the first entries of `selection`,
+     * or 0 if `selection` is too small.
+     */
+    template<typename T, typename Predicate>
+    size_t filter_selection(std::span<const T> column, const Predicate& predicate, std::span<std::uint32_t> selection)
+    {
+        if (selection.size() < column.size())
+            return 0;
+
+        size_t n = 0;
+        detail::for_each_filter_word(column, predicate, [&](size_t w, std::uint64_t word)
+            {
+                for (; word != 0; word &= word - 1)
+                    selection[n++] = std::uint32_t(w * 64 + size_t(std::countr_zero(word)));
+            });
+        return n;
+    }
+
+    /**
+     * @brief Keeps the rows of a selection vector for which a predicate on another column holds.
+     *
+     * Only the selected rows are read, so a selective first predicate makes the second one cheap.
+     *
+     * @param selection The selection to refine in place, e.g. the output of `filter_selection`.
+     * @return The number of rows left, which are the first entries of `selection`.
+     */
+    template<typename T, typename Predicate>
+    size_t refine_selection(std::span<const T> column, const Predicate& predicate, std::span<std::uint32_t> selection) noexcept
+    {
+        size_t n = 0;
+        for (const std::uint32_t row : selection)
+        {
+            selection[n] = row;
+            n += size_t(predicate(column[row]));
+        }
+        return n;
+    }
+
+    /**
+     * @brief Keeps the rows selected by both bitmaps, in `bitmap`.
+     */
+    inline void bitmap_and(std::span<std::uint64_t> bitmap, std::span<const std::uint64_t> other) noexcept
+    {
+        for (size_t w = 0; w < bitmap.size() && w < other.size(); ++w)
+            bitmap[w] &= other[w];
+    }
+
+    /**
+     * @brief Keeps the rows selected by either bitmap, in `bitmap`.
+     */
+    inline void bitmap_or(std::span<std::uint64_t> bitmap, std::span<const std::uint64_t> other) noexcept
+    {
+        for (size_t w = 0; w < bitmap.size() && w < other.size(); ++w)
+            bitmap[w] |= other[w];
+    }
+
+    /**
+     * @brief Appends a tuple built from `columns...[row]` to `out` for every row of a selection.
+     *
+     * Only the selected rows of each column are read: this is the late materialization that
+     * follows filtering, instead of filtering rows that were all built up front.
+     */
+    template<typename Tuple, typename... Columns>
+    void materialize(std::span<const std::uint32_t> selection, std::vector<Tuple>& out, const Columns&... columns)
+    {
+        static_assert(sizeof...(Columns) == detail::tuple_size_v<Tuple>, "one column per tuple element is required");
+        out.reserve(out.size() + selection.size());
+        for (const std::uint32_t row : selection)
+            out.emplace_back(std::data(columns)[row]...);
+    }
+}
+
+#endif
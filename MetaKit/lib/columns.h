@@ -0,0 +1,338 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "tuple.h"
+#include "type_list.h"
+
+/**
+ * @brief Bulk transposition between rows of tuples (AoS) and one array per element (SoA).
+ *
+ * `scatter_to_columns(rows, columns...)` copies element `i` of every row to `columns[i]`, and
+ * `gather_from_columns(rows, columns...)` copies them back. Rows and columns are contiguous
+ * ranges (`std::vector`, `std::span`, arrays) and the columns must already hold as many
+ * elements as there are rows.
+ *
+ * The kernels are generated from the tuple's element `type_list`:
+ * - every input is processed in blocks of rows small enough for the rows and the matching
+ *   part of every column to stay in L1, so each cache line is loaded once;
+ * - rows whose elements all share one 4- or 8-byte arithmetic type, two or four of them,
+ *   are transposed as small matrices with SSE2 shuffles on x86;
+ * - inputs of at least `parallel_rows` rows are split into chunks, one per hardware thread.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief The number of rows from which the transposition runs on all hardware threads.
+     */
+    inline constexpr size_t parallel_rows = size_t(1) << 18;
+
+    namespace detail
+    {
+        /**
+         * @brief The rows of one block, sized so that a block of rows and its columns fit in L1.
+         */
+        template<typename Row>
+        inline constexpr size_t transpose_block_rows = std::max<size_t>(16, (16 * 1024) / sizeof(Row));
+
+        /**
+         * @brief The element type list of a tuple.
+         */
+        template<typename Tuple>
+        struct element_list;
+
+        template<typename... Ts>
+        struct element_list<tuple<Ts...>> : has_type<type_list<Ts...>> {};
+
+        /**
+         * @brief Checks whether rows of `Tuple` are `N` elements of one 4- or 8-byte arithmetic type with no padding.
+         */
+        template<typename Tuple>
+        struct shuffle_transposable : false_type {};
+
+        template<typename T, typename... Ts>
+        struct shuffle_transposable<tuple<T, Ts...>> : bool_constant<
+            (is_same_v<T, Ts> && ...) && std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8) &&
+            (sizeof...(Ts) == 1 || sizeof...(Ts) == 3) && sizeof(tuple<T, Ts...>) == sizeof(T) * (sizeof...(Ts) + 1)> {};
+
+        /**
+         * @brief Copies one element of every row of a block to its column; the compiler vectorizes where it can.
+         */
+        template<size_t i, typename Row, typename Column>
+        METAKIT_ALWAYS_INLINE void scatter_element(const Row* rows, size_t n, Column* column) noexcept
+        {
+            for (size_t r = 0; r < n; ++r)
+                column[r] = get<i>(rows[r]);
+        }
+
+        template<size_t i, typename Row, typename Column>
+        METAKIT_ALWAYS_INLINE void gather_element(Row* rows, size_t n, const Column* column) noexcept
+        {
+            for (size_t r = 0; r < n; ++r)
+                get<i>(rows[r]) = column[r];
+        }
+
+        /**
+         * @brief Transposes a block of rows of `lanes` elements of `T`; `columns[l]` receives memory lane `l`.
+         *
+         * Handles a multiple of four rows with SSE2 and leaves the rest to the caller.
+         *
+         * @return The number of rows transposed.
+         */
+        template<typename T, size_t lanes>
+        size_t shuffle_scatter(const T* in, size_t n, T* const* columns) noexcept
+        {
+            size_t r = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            if constexpr (sizeof(T) == 4 && lanes == 4)
+            {
+                for (; r + 4 <= n; r += 4)
+                {
+                    const __m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(in + r * 4));
+                    const __m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(in + r * 4 + 4));
+                    const __m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(in + r * 4 + 8));
+                    const __m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(in + r * 4 + 12));
+                    const __m128 t0 = _mm_unpacklo_ps(r0, r1), t1 = _mm_unpacklo_ps(r2, r3);
+                    const __m128 t2 = _mm_unpackhi_ps(r0, r1), t3 = _mm_unpackhi_ps(r2, r3);
+                    _mm_storeu_ps(reinterpret_cast<float*>(columns[0] + r), _mm_movelh_ps(t0, t1));
+                    _mm_storeu_ps(reinterpret_cast<float*>(columns[1] + r), _mm_movehl_ps(t1, t0));
+                    _mm_storeu_ps(reinterpret_cast<float*>(columns[2] + r), _mm_movelh_ps(t2, t3));
+                    _mm_storeu_ps(reinterpret_cast<float*>(columns[3] + r), _mm_movehl_ps(t3, t2));
+                }
+            }
+            else if constexpr (sizeof(T) == 4 && lanes == 2)
+            {
+                for (; r + 4 <= n; r += 4)
+                {
+                    const __m128 r01 = _mm_loadu_ps(reinterpret_cast<const float*>(in + r * 2));
+                    const __m128 r23 = _mm_loadu_ps(reinterpret_cast<const float*>(in + r * 2 + 4));
+                    _mm_storeu_ps(reinterpret_cast<float*>(columns[0] + r), _mm_shuffle_ps(r01, r23, _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm_storeu_ps(reinterpret_cast<float*>(columns[1] + r), _mm_shuffle_ps(r01, r23, _MM_SHUFFLE(3, 1, 3, 1)));
+                }
+            }
+            else if constexpr (sizeof(T) == 8)
+            {
+                for (; r + 4 <= n; r += 4)
+                {
+                    for (size_t half = 0; half < 4; half += 2)
+                    {
+                        for (size_t l = 0; l < lanes; l += 2)
+                        {
+                            const __m128d a = _mm_loadu_pd(reinterpret_cast<const double*>(in + (r + half) * lanes + l));
+                            const __m128d b = _mm_loadu_pd(reinterpret_cast<const double*>(in + (r + half + 1) * lanes + l));
+                            _mm_storeu_pd(reinterpret_cast<double*>(columns[l] + r + half), _mm_unpacklo_pd(a, b));
+                            _mm_storeu_pd(reinterpret_cast<double*>(columns[l + 1] + r + half), _mm_unpackhi_pd(a, b));
+                        }
+                    }
+                }
+            }
+#else
+            (void)in; (void)n; (void)columns;
+#endif
+            return r;
+        }
+
+        /**
+         * @brief The inverse of `shuffle_scatter`: writes memory lane `l` of every row from `columns[l]`.
+         */
+        template<typename T, size_t lanes>
+        size_t shuffle_gather(T* out, size_t n, const T* const* columns) noexcept
+        {
+            size_t r = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            if constexpr (sizeof(T) == 4 && lanes == 4)
+            {
+                for (; r + 4 <= n; r += 4)
+                {
+                    const __m128 c0 = _mm_loadu_ps(reinterpret_cast<const float*>(columns[0] + r));
+                    const __m128 c1 = _mm_loadu_ps(reinterpret_cast<const float*>(columns[1] + r));
+                    const __m128 c2 = _mm_loadu_ps(reinterpret_cast<const float*>(columns[2] + r));
+                    const __m128 c3 = _mm_loadu_ps(reinterpret_cast<const float*>(columns[3] + r));
+                    const __m128 t0 = _mm_unpacklo_ps(c0, c1), t1 = _mm_unpacklo_ps(c2, c3);
+                    const __m128 t2 = _mm_unpackhi_ps(c0, c1), t3 = _mm_unpackhi_ps(c2, c3);
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r * 4), _mm_movelh_ps(t0, t1));
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r * 4 + 4), _mm_movehl_ps(t1, t0));
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r * 4 + 8), _mm_movelh_ps(t2, t3));
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r * 4 + 12), _mm_movehl_ps(t3, t2));
+                }
+            }
+            else if constexpr (sizeof(T) == 4 && lanes == 2)
+            {
+                for (; r + 4 <= n; r += 4)
+                {
+                    const __m128 c0 = _mm_loadu_ps(reinterpret_cast<const float*>(columns[0] + r));
+                    const __m128 c1 = _mm_loadu_ps(reinterpret_cast<const float*>(columns[1] + r));
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r * 2), _mm_unpacklo_ps(c0, c1));
+                    _mm_storeu_ps(reinterpret_cast<float*>(out + r * 2 + 4), _mm_unpackhi_ps(c0, c1));
+                }
+            }
+            else if constexpr (sizeof(T) == 8)
+            {
+                for (; r + 4 <= n; r += 4)
+                {
+                    for (size_t half = 0; half < 4; half += 2)
+                    {
+                        for (size_t l = 0; l < lanes; l += 2)
+                        {
+                            const __m128d a = _mm_loadu_pd(reinterpret_cast<const double*>(columns[l] + r + half));
+                            const __m128d b = _mm_loadu_pd(reinterpret_cast<const double*>(columns[l + 1] + r + half));
+                            _mm_storeu_pd(reinterpret_cast<double*>(out + (r + half) * lanes + l), _mm_unpacklo_pd(a, b));
+                            _mm_storeu_pd(reinterpret_cast<double*>(out + (r + half + 1) * lanes + l), _mm_unpackhi_pd(a, b));
+                        }
+                    }
+                }
+            }
+#else
+            (void)out; (void)n; (void)columns;
+#endif
+            return r;
+        }
+
+        /**
+         * @brief Retrieves the memory lane of every element of a row, i.e. its offset in elements.
+         */
+        template<typename Row, typename T, size_t... indices>
+        void element_lanes(const Row& row, size_t* lanes, index_sequence<indices...>) noexcept
+        {
+            const auto* base = reinterpret_cast<const unsigned char*>(&row);
+            ((lanes[indices] = size_t(reinterpret_cast<const unsigned char*>(&get<indices>(row)) - base) / sizeof(T)), ...);
+        }
+
+        template<typename Row, typename... Columns, size_t... indices>
+        void scatter_range(const Row* rows, size_t n, index_sequence<indices...>, Columns*... columns) noexcept
+        {
+            constexpr size_t block = transpose_block_rows<Row>;
+            if constexpr (shuffle_transposable<Row>::value)
+            {
+                using T = front_t<typename element_list<Row>::type>;
+                constexpr size_t lanes = sizeof...(indices);
+                if (n != 0)
+                {
+                    size_t lane_of[lanes];
+                    element_lanes<Row, T>(rows[0], lane_of, index_sequence<indices...>{});
+                    T* by_lane[lanes];
+                    ((by_lane[lane_of[indices]] = columns), ...);
+                    const size_t done = shuffle_scatter<T, lanes>(reinterpret_cast<const T*>(rows), n, by_lane);
+                    rows += done;
+                    n -= done;
+                    ((columns += done), ...);
+                }
+            }
+            for (size_t begin = 0; begin < n; begin += block)
+            {
+                const size_t count = std::min(block, n - begin);
+                (scatter_element<indices>(rows + begin, count, columns + begin), ...);
+            }
+        }
+
+        template<typename Row, typename... Columns, size_t... indices>
+        void gather_range(Row* rows, size_t n, index_sequence<indices...>, const Columns*... columns) noexcept
+        {
+            constexpr size_t block = transpose_block_rows<Row>;
+            if constexpr (shuffle_transposable<Row>::value)
+            {
+                using T = front_t<typename element_list<Row>::type>;
+                constexpr size_t lanes = sizeof...(indices);
+                if (n != 0)
+                {
+                    size_t lane_of[lanes];
+                    element_lanes<Row, T>(rows[0], lane_of, index_sequence<indices...>{});
+                    const T* by_lane[lanes];
+                    ((by_lane[lane_of[indices]] = columns), ...);
+                    const size_t done = shuffle_gather<T, lanes>(reinterpret_cast<T*>(rows), n, by_lane);
+                    rows += done;
+                    n -= done;
+                    ((columns += done), ...);
+                }
+            }
+            for (size_t begin = 0; begin < n; begin += block)
+            {
+                const size_t count = std::min(block, n - begin);
+                (gather_element<indices>(rows + begin, count, columns + begin), ...);
+            }
+        }
+
+        /**
+         * @brief Runs `range(begin, count)` over `n` rows, on all hardware threads for large inputs.
+         *
+         * Chunks are multiples of 64 rows, so that threads never write to the same cache line
+         * of a column of elements of at least one byte.
+         */
+        template<typename Range>
+        void for_each_chunk(size_t n, const Range& range)
+        {
+            const size_t threads = n < parallel_rows ? 1 : std::max<size_t>(1, std::thread::hardware_concurrency());
+            if (threads == 1)
+            {
+                range(size_t(0), n);
+                return;
+            }
+
+            const size_t chunk = (n / threads + 63) / 64 * 64;
+            std::vector<std::jthread> workers;
+            workers.reserve(threads - 1);
+            for (size_t begin = chunk; begin < n; begin += chunk)
+                workers.emplace_back([&range, begin, count = std::min(chunk, n - begin)] { range(begin, count); });
+            range(size_t(0), std::min(chunk, n));
+        }
+
+        template<typename Rows>
+        using row_t = remove_cvrf_t<decltype(*std::data(std::declval<Rows&>()))>;
+    }//end of namespace detail
+
+    /**
+     * @brief Copies element `i` of every row to `columns...[i]`.
+     *
+     * @param rows A contiguous range of `tuple`s.
+     * @param columns One contiguous range per element, of the element's type and with at least as many elements as `rows`.
+     */
+    template<typename Rows, typename... Columns>
+    void scatter_to_columns(const Rows& rows, Columns&&... columns)
+    {
+        using row = detail::row_t<const Rows>;
+        static_assert(sizeof...(Columns) == detail::tuple_size_v<row>, "one column per tuple element is required");
+        static_assert(is_same_v<typename detail::element_list<row>::type,
+            type_list<remove_cvrf_t<decltype(*std::data(columns))>...>>, "column types must match the tuple's element types");
+
+        const row* in = std::data(rows);
+        detail::for_each_chunk(std::size(rows), [&](size_t begin, size_t count)
+            {
+                detail::scatter_range(in + begin, count, make_index_sequence<sizeof...(Columns)>{}, (std::data(columns) + begin)...);
+            });
+    }
+
+    /**
+     * @brief Sets element `i` of every row from `columns...[i]`.
+     *
+     * @param rows A contiguous range of `tuple`s, which are assigned to element by element.
+     * @param columns One contiguous range per element, of the element's type and with at least as many elements as `rows`.
+     */
+    template<typename Rows, typename... Columns>
+    void gather_from_columns(Rows& rows, const Columns&... columns)
+    {
+        using row = detail::row_t<Rows>;
+        static_assert(sizeof...(Columns) == detail::tuple_size_v<row>, "one column per tuple element is required");
+        static_assert(is_same_v<typename detail::element_list<row>::type,
+            type_list<remove_cvrf_t<decltype(*std::data(columns))>...>>, "column types must match the tuple's element types");
+
+        row* out = std::data(rows);
+        detail::for_each_chunk(std::size(rows), [&](size_t begin, size_t count)
+            {
+                detail::gather_range(out + begin, count, make_index_sequence<sizeof...(Columns)>{}, (std::data(columns) + begin)...);
+            });
+    }
+}
+
+#endif
@@ -0,0 +1,561 @@
+#ifndef CONCURRENT_MAP_H
+#define CONCURRENT_MAP_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "per_thread.h"
+#include "tuple_hash.h"
+
+namespace metakit
+{
+    namespace detail
+    {
+        /**
+         * @brief A thread's announcement to `concurrent_map` writers: the epoch its optimistic read began in, or 0.
+         */
+        struct reader_epoch
+        {
+            std::atomic<std::uint64_t> announced{ 0 };
+        };
+
+        /**
+         * @brief The reclamation epoch of all `concurrent_map`s; it advances whenever a table is retired.
+         */
+        inline std::atomic<std::uint64_t> table_epoch{ 1 };
+
+        /**
+         * @brief The announcements of every thread that read a `concurrent_map` optimistically, each on its own cache line.
+         *
+         * Never destroyed, so that maps used during static destruction still find it.
+         */
+        inline per_thread<reader_epoch>& reader_epochs()
+        {
+            static per_thread<reader_epoch>* const epochs = new per_thread<reader_epoch>;
+            return *epochs;
+        }
+    }//end of namespace detail
+
+    /**
+     * @brief Hash map for concurrent use, sharded by the hash of its tuple keys.
+     *
+     * The high bits of a key's hash pick one of `Shards` shards; each shard is a flat
+     * open-addressing table with linear probing and one control byte per slot (empty,
+     * erased, or 7 bits of the hash to reject most mismatches without touching the key).
+     * Writers lock their shard only, so writers on different shards never contend.
+     *
+     * When keys and values are trivially copyable, lookups take no lock: they read the
+     * shard's sequence counter, probe, copy the value out and accept the result if the
+     * counter did not change (a seqlock). Such readers write nothing shared: each announces
+     * the global reclamation epoch in a slot of its own thread, and a table replaced by growth
+     * is freed once no reader announces an epoch from before the replacement, so an optimistic
+     * reader never probes freed memory; as growth doubles the capacity, the retired tables of
+     * a shard add up to less than its current one. A rehash that only purges erased slots
+     * rebuilds the table in place, so insert and erase churn allocates nothing. Other key and
+     * value types look up under the shard lock and free replaced tables immediately.
+     *
+     * @tparam Key The key type, usually a `tuple`.
+     * @tparam Value The mapped type.
+     * @tparam Shards The number of shards, a power of two.
+     * @tparam Hash The hash function; its high bits must be well mixed.
+     * @tparam Equal The key equality.
+     */
+    template<typename Key, typename Value, size_t Shards = 64, typename Hash = tuple_hash, typename Equal = tuple_equal>
+    class concurrent_map
+    {
+        static_assert(std::has_single_bit(Shards), "the shard count must be a power of two");
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+
+        static constexpr size_t shard_count = Shards; ///< The number of shards.
+
+        /**
+         * @brief Whether lookups run without a lock.
+         */
+        static constexpr bool optimistic_reads = is_trivially_copyable_v<Key> && is_trivially_copyable_v<Value>;
+
+        /**
+         * @param expected_size The number of entries to size the shards for.
+         */
+        explicit concurrent_map(size_t expected_size = 0)
+        {
+            const size_t per_shard = expected_size / Shards + 1;
+            for (auto& s : shards)
+                s.current.store(s.adopt(new_table(std::bit_ceil(per_shard + per_shard / 4 + minimum_capacity))), std::memory_order_relaxed);
+        }
+
+        concurrent_map(const concurrent_map&) = delete;
+        concurrent_map& operator=(const concurrent_map&) = delete;
+
+        ~concurrent_map()
+        {
+            for (auto& s : shards)
+                destroy_entries(*s.current.load(std::memory_order_relaxed));
+        }
+
+        /**
+         * @brief Inserts an entry or replaces the value of an existing one.
+         *
+         * @return Whether the key was inserted, as opposed to updated.
+         */
+        bool insert_or_assign(const Key& key, const Value& value)
+        {
+            const std::uint64_t h = Hash{}(key);
+            shard& s = shard_of(h);
+            std::lock_guard lock(s.mutex);
+            write_guard write(s);
+
+            table* t = s.current.load(std::memory_order_relaxed);
+            if (const size_t found = probe(*t, key, h); found != not_found)
+            {
+                t->entry_at(found)->value = value;
+                return false;
+            }
+            if ((s.size + s.erased + 1) * 8 > t->capacity * 7)
+                t = grow(s);
+            else if (s.tables.size() > 1)
+                release_retired(s);
+
+            const size_t slot = free_slot(*t, h);
+            if (t->control[slot].load(std::memory_order_relaxed) == erased)
+                --s.erased;
+            ::new (static_cast<void*>(t->entry_at(slot))) entry{ key, value };
+            t->control[slot].store(tag_of(h), std::memory_order_relaxed);
+            ++s.size;
+            return true;
+        }
+
+        /**
+         * @brief Removes an entry.
+         *
+         * @return Whether the key was present.
+         */
+        bool erase(const Key& key)
+        {
+            const std::uint64_t h = Hash{}(key);
+            shard& s = shard_of(h);
+            std::lock_guard lock(s.mutex);
+
+            table* t = s.current.load(std::memory_order_relaxed);
+            const size_t found = probe(*t, key, h);
+            if (found == not_found)
+                return false;
+
+            write_guard write(s);
+            t->control[found].store(erased, std::memory_order_relaxed);
+            t->entry_at(found)->~entry();
+            --s.size;
+            ++s.erased;
+            return true;
+        }
+
+        /**
+         * @brief Looks a key up.
+         *
+         * @return A copy of the value, or `std::nullopt` if the key is absent.
+         */
+        std::optional<Value> find(const Key& key) const
+        {
+            const std::uint64_t h = Hash{}(key);
+            return read_shard(shard_of(h), [&](const table& t) { return copy_value(t, key, h); });
+        }
+
+        /**
+         * @brief Checks whether a key is present.
+         */
+        bool contains(const Key& key) const { return find(key).has_value(); }
+
+        /**
+         * @brief Looks many keys up, visiting each shard once.
+         *
+         * Keys are hashed and grouped by shard first; every group is then probed under a single
+         * lock acquisition or optimistic read, with the slots of the next keys prefetched.
+         *
+         * @param keys The keys to look up.
+         * @param values Receives the value of `keys[i]` at `values[i]`; at least as long as `keys`.
+         * @return The number of keys found.
+         */
+        size_t find_many(std::span<const Key> keys, std::span<std::optional<Value>> values) const
+        {
+            const size_t n = keys.size();
+            std::vector<std::uint64_t> hashes(n);
+            std::vector<std::uint32_t> order(n);
+            std::vector<std::uint32_t> starts(Shards + 1, 0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                hashes[i] = Hash{}(keys[i]);
+                ++starts[shard_index(hashes[i]) + 1];
+            }
+            for (size_t s = 0; s < Shards; ++s)
+                starts[s + 1] += starts[s];
+            {
+                std::vector<std::uint32_t> next(starts.begin(), starts.end() - 1);
+                for (size_t i = 0; i < n; ++i)
+                    order[next[shard_index(hashes[i])]++] = std::uint32_t(i);
+            }
+
+            size_t found = 0;
+            for (size_t s = 0; s < Shards; ++s)
+            {
+                if (starts[s] == starts[s + 1])
+                    continue;
+                found += read_shard(shards[s], [&](const table& t)
+                    {
+                        size_t hits = 0;
+                        for (size_t k = starts[s]; k < starts[s + 1]; ++k)
+                        {
+                            if (k + 1 < starts[s + 1])
+                                detail::prefetch(&t.control[hashes[order[k + 1]] & t.mask]);
+                            const size_t i = order[k];
+                            values[i] = copy_value(t, keys[i], hashes[i]);
+                            hits += values[i].has_value();
+                        }
+                        return hits;
+                    });
+            }
+            return found;
+        }
+
+        /**
+         * @brief Retrieves the bytes of the shards' tables, retired ones included.
+         */
+        size_t table_bytes() const
+        {
+            size_t total = 0;
+            for (const auto& s : shards)
+            {
+                std::lock_guard lock(s.mutex);
+                for (const auto& t : s.tables)
+                    total += t->capacity * (sizeof(entry) + 1);
+            }
+            return total;
+        }
+
+        /**
+         * @brief Retrieves the number of entries; exact only while no thread writes.
+         */
+        size_t size() const
+        {
+            size_t total = 0;
+            for (const auto& s : shards)
+            {
+                std::lock_guard lock(s.mutex);
+                total += s.size;
+            }
+            return total;
+        }
+
+    private:
+        struct entry
+        {
+            Key key;
+            Value value;
+        };
+
+        static_assert(alignof(entry) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over-aligned keys and values are not supported");
+
+        static constexpr std::uint8_t empty = 0;
+        static constexpr std::uint8_t erased = 1;
+        static constexpr size_t minimum_capacity = 16;
+        static constexpr size_t not_found = ~size_t(0);
+
+        /**
+         * @brief The slots of one shard: control bytes, and entry storage constructed on insertion.
+         */
+        struct table
+        {
+            size_t capacity;
+            size_t mask;
+            std::uint64_t retired_at = 0; ///< The `detail::table_epoch` that its replacement started.
+            std::unique_ptr<std::atomic<std::uint8_t>[]> control;
+            std::unique_ptr<std::byte[]> storage;
+
+            entry* entry_at(size_t slot) const noexcept
+            {
+                return std::launder(reinterpret_cast<entry*>(storage.get() + slot * sizeof(entry)));
+            }
+        };
+
+        struct alignas(64) shard
+        {
+            mutable std::mutex mutex;
+            std::atomic<std::uint64_t> version{ 0 }; ///< Odd while a writer modifies the table.
+            std::atomic<table*> current{ nullptr };
+            size_t size = 0;
+            size_t erased = 0;
+            std::vector<std::unique_ptr<table>> tables; ///< The current table and the retired ones still kept for readers.
+
+            table* adopt(std::unique_ptr<table> t)
+            {
+                tables.push_back(metakit::move(t));
+                return tables.back().get();
+            }
+        };
+
+        /**
+         * @brief Makes the shard's sequence counter odd for the lifetime of the object.
+         */
+        struct write_guard
+        {
+            shard& s;
+
+            explicit write_guard(shard& target) : s(target)
+            {
+                s.version.store(s.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+            }
+
+            ~write_guard()
+            {
+                s.version.store(s.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+        };
+
+        static size_t shard_index(std::uint64_t h) noexcept
+        {
+            if constexpr (Shards == 1)
+                return 0;
+            else
+                return size_t(h >> (64 - std::countr_zero(Shards)));
+        }
+
+        static std::uint8_t tag_of(std::uint64_t h) noexcept { return std::uint8_t(0x80 | ((h >> 48) & 0x7f)); }
+
+        shard& shard_of(std::uint64_t h) { return shards[shard_index(h)]; }
+        const shard& shard_of(std::uint64_t h) const { return shards[shard_index(h)]; }
+
+        static std::unique_ptr<table> new_table(size_t capacity)
+        {
+            auto t = std::make_unique<table>();
+            t->capacity = capacity;
+            t->mask = capacity - 1;
+            t->control = std::make_unique<std::atomic<std::uint8_t>[]>(capacity);
+            t->storage = std::make_unique<std::byte[]>(capacity * sizeof(entry));
+            return t;
+        }
+
+        static void destroy_entries(table& t)
+        {
+            if constexpr (!std::is_trivially_destructible_v<entry>)
+                for (size_t i = 0; i < t.capacity; ++i)
+                    if (t.control[i].load(std::memory_order_relaxed) >= 0x80)
+                        t.entry_at(i)->~entry();
+        }
+
+        /**
+         * @brief Retrieves the slot of a key, or `not_found`.
+         */
+        static size_t probe(const table& t, const Key& key, std::uint64_t h)
+        {
+            const std::uint8_t tag = tag_of(h);
+            for (size_t i = h & t.mask, steps = 0; steps < t.capacity; i = (i + 1) & t.mask, ++steps)
+            {
+                const std::uint8_t c = t.control[i].load(std::memory_order_relaxed);
+                if (c == empty)
+                    return not_found;
+                if (c == tag && Equal{}(t.entry_at(i)->key, key))
+                    return i;
+            }
+            return not_found;
+        }
+
+        /**
+         * @brief Retrieves the first empty or erased slot on the probe sequence of a hash.
+         */
+        static size_t free_slot(const table& t, std::uint64_t h)
+        {
+            size_t i = h & t.mask;
+            while (t.control[i].load(std::memory_order_relaxed) >= 0x80)
+                i = (i + 1) & t.mask;
+            return i;
+        }
+
+        /**
+         * @brief Copies the value of a key out of a table that may be written concurrently.
+         *
+         * For optimistic reads the key and value are copied as bytes before they are looked at,
+         * so a torn copy is only ever compared or returned after validation rejects it.
+         */
+        static std::optional<Value> copy_value(const table& t, const Key& key, std::uint64_t h)
+        {
+            if constexpr (optimistic_reads)
+            {
+                const std::uint8_t tag = tag_of(h);
+                for (size_t i = h & t.mask, steps = 0; steps < t.capacity; i = (i + 1) & t.mask, ++steps)
+                {
+                    const std::uint8_t c = t.control[i].load(std::memory_order_acquire);
+                    if (c == empty)
+                        return std::nullopt;
+                    if (c != tag)
+                        continue;
+                    alignas(entry) std::byte copy[sizeof(entry)];
+                    std::memcpy(copy, t.storage.get() + i * sizeof(entry), sizeof(entry));
+                    const entry& e = *std::launder(reinterpret_cast<const entry*>(copy));
+                    if (Equal{}(e.key, key))
+                        return e.value;
+                }
+                return std::nullopt;
+            }
+            else
+            {
+                const size_t found = probe(t, key, h);
+                return found == not_found ? std::nullopt : std::optional<Value>(t.entry_at(found)->value);
+            }
+        }
+
+        /**
+         * @brief Runs a read of a shard's table, optimistically if possible and under the lock otherwise.
+         */
+        template<typename Read>
+        static auto read_shard(const shard& s, const Read& read)
+        {
+            if constexpr (optimistic_reads)
+            {
+                reader_guard reading;
+                for (int attempt = 0; attempt < 4; ++attempt)
+                {
+                    const std::uint64_t before = s.version.load(std::memory_order_acquire);
+                    if (before & 1)
+                        continue;
+                    auto result = read(*s.current.load(std::memory_order_seq_cst));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (s.version.load(std::memory_order_relaxed) == before)
+                        return result;
+                }
+            }
+            std::lock_guard lock(s.mutex);
+            return read(*s.current.load(std::memory_order_relaxed));
+        }
+
+        /**
+         * @brief Announces the current epoch in the calling thread's slot for the lifetime of the object.
+         *
+         * The epoch load, the announcement and the reader's load of `current` are sequentially
+         * consistent, like the writer's swap of `current`, epoch increment and scan of the slots.
+         * A reader that announces the epoch a replacement started thus loads the new table, and
+         * so does one whose announcement the scan missed.
+         */
+        struct reader_guard
+        {
+            std::atomic<std::uint64_t>& announced = detail::reader_epochs().local().announced;
+
+            reader_guard()
+            {
+                announced.store(detail::table_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            }
+
+            ~reader_guard()
+            {
+                announced.store(0, std::memory_order_release);
+            }
+        };
+
+        /**
+         * @brief Frees a shard's retired tables that no optimistic reader may still hold.
+         */
+        static void release_retired(shard& s)
+        {
+            std::uint64_t oldest = ~std::uint64_t(0);
+            detail::reader_epochs().for_each([&](const detail::reader_epoch& r)
+                {
+                    const std::uint64_t e = r.announced.load(std::memory_order_seq_cst);
+                    if (e != 0 && e < oldest)
+                        oldest = e;
+                });
+            const table* current = s.current.load(std::memory_order_relaxed);
+            std::erase_if(s.tables, [&](const std::unique_ptr<table>& t) { return t.get() != current && t->retired_at <= oldest; });
+        }
+
+        /**
+         * @brief Rehashes a table's entries in place, dropping erased slots; the shard's version must be odd.
+         *
+         * Optimistic readers that probe meanwhile are rejected by the version check.
+         */
+        static void purge(shard& s, table& t)
+        {
+            const auto live = std::make_unique<std::byte[]>(s.size * sizeof(entry));
+            size_t n = 0;
+            for (size_t i = 0; i < t.capacity; ++i)
+            {
+                if (t.control[i].load(std::memory_order_relaxed) >= 0x80)
+                    std::memcpy(live.get() + n++ * sizeof(entry), t.entry_at(i), sizeof(entry));
+                t.control[i].store(empty, std::memory_order_relaxed);
+            }
+            for (size_t k = 0; k < n; ++k)
+            {
+                const entry* e = std::launder(reinterpret_cast<const entry*>(live.get() + k * sizeof(entry)));
+                const std::uint64_t h = Hash{}(e->key);
+                const size_t slot = free_slot(t, h);
+                std::memcpy(static_cast<void*>(t.entry_at(slot)), e, sizeof(entry));
+                t.control[slot].store(tag_of(h), std::memory_order_relaxed);
+            }
+            s.erased = 0;
+        }
+
+        /**
+         * @brief Moves a shard's entries into a table twice as large, or purges erased slots if it is full of them.
+         *
+         * With optimistic reads, the old table is kept until no reader may hold it, and a purge
+         * happens in place; otherwise the old table is freed at once.
+         */
+        table* grow(shard& s)
+        {
+            table* old = s.current.load(std::memory_order_relaxed);
+            const size_t capacity = s.size * 8 > old->capacity * 3 ? old->capacity * 2 : old->capacity;
+            if constexpr (optimistic_reads)
+            {
+                if (capacity == old->capacity)
+                {
+                    purge(s, *old);
+                    release_retired(s);
+                    return old;
+                }
+            }
+            table* fresh = s.adopt(new_table(capacity));
+            for (size_t i = 0; i < old->capacity; ++i)
+            {
+                if (old->control[i].load(std::memory_order_relaxed) < 0x80)
+                    continue;
+                entry* e = old->entry_at(i);
+                const std::uint64_t h = Hash{}(e->key);
+                const size_t slot = free_slot(*fresh, h);
+                if constexpr (optimistic_reads)
+                    ::new (static_cast<void*>(fresh->entry_at(slot))) entry(*e); // readers may still copy the old entry
+                else
+                {
+                    ::new (static_cast<void*>(fresh->entry_at(slot))) entry(metakit::move(*e));
+                    e->~entry();
+                }
+                fresh->control[slot].store(tag_of(h), std::memory_order_relaxed);
+            }
+            s.erased = 0;
+            if constexpr (!optimistic_reads)
+            {
+                // Nobody reads retired tables without the lock, so they need not be kept.
+                s.tables.erase(s.tables.end() - 2);
+            }
+            s.current.store(fresh, std::memory_order_seq_cst);
+            if constexpr (optimistic_reads)
+            {
+                old->retired_at = detail::table_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+                release_retired(s);
+            }
+            return fresh;
+        }
+
+        shard shards[Shards];
+    };
+}
+
+#endif
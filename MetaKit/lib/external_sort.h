@@ -0,0 +1,483 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "tuple.h"
+
+/**
+ * @brief External merge sort of files of fixed-size tuple records, for files larger than memory.
+ *
+ * A record file holds trivially copyable tuples back to back, in their in-memory representation.
+ * `external_sort<Tuple, Keys...>` orders it by the elements at `Keys...`, compared
+ * lexicographically, in two phases:
+ * - run generation reads the input sequentially in chunks, while up to `threads` earlier chunks
+ *   are sorted and written as run files in parallel; each chunk is merge sorted in place with a
+ *   scratch buffer of half its size, so that a thread's share of the budget holds both;
+ * - a loser tree merges the runs, each read and the output written through buffers of several
+ *   megabytes so that every access is large and sequential; when there are too many runs for
+ *   the budget, groups of them are merged into longer runs first.
+ *
+ * The sort is stable. Every buffer it allocates comes out of `memory_budget`.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief Tuning of `external_sort`.
+     */
+    struct external_sort_options
+    {
+        size_t memory_budget = size_t(256) << 20;  ///< The bytes of all record buffers together.
+        size_t threads = 0;                        ///< Runs sorted in parallel; 0 for the hardware threads.
+        size_t io_buffer = size_t(4) << 20;        ///< The smallest read or write buffer of the merge, in bytes.
+        std::filesystem::path temp_directory;      ///< Where runs are written; empty for the output's directory.
+    };
+
+    /**
+     * @brief What an `external_sort` did.
+     */
+    struct external_sort_stats
+    {
+        size_t records = 0;           ///< The number of records sorted.
+        size_t runs = 0;              ///< The number of runs generated from the input.
+        size_t merge_passes = 0;      ///< The passes over the data after run generation.
+        size_t peak_buffer_bytes = 0; ///< The most bytes of buffers allocated at once.
+        double run_seconds = 0;       ///< The time to generate the runs.
+        double merge_seconds = 0;     ///< The time to merge them.
+    };
+
+    /**
+     * @brief Orders tuples by the elements at `Keys...`, compared lexicographically.
+     */
+    template<size_t... Keys>
+    struct key_less
+    {
+        template<typename Tuple>
+        constexpr bool operator()(const Tuple& a, const Tuple& b) const
+        {
+            bool less = false;
+            ((get<Keys>(a) < get<Keys>(b) ? (less = true, true) : get<Keys>(b) < get<Keys>(a)) || ...);
+            return less;
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Uninitialized storage for records, which are created by reading their bytes into it.
+         */
+        template<typename Tuple>
+        class record_buffer
+        {
+        public:
+            explicit record_buffer(size_t capacity)
+                : records_(static_cast<Tuple*>(::operator new(capacity * sizeof(Tuple), std::align_val_t(alignof(Tuple))))),
+                capacity_(capacity)
+            {}
+
+            Tuple* data() const noexcept { return records_.get(); }
+            size_t capacity() const noexcept { return capacity_; }
+            size_t bytes() const noexcept { return capacity_ * sizeof(Tuple); }
+
+        private:
+            struct release
+            {
+                void operator()(Tuple* p) const noexcept { ::operator delete(p, std::align_val_t(alignof(Tuple))); }
+            };
+
+            std::unique_ptr<Tuple, release> records_;
+            size_t capacity_;
+        };
+
+        struct file_close
+        {
+            void operator()(std::FILE* f) const noexcept { std::fclose(f); }
+        };
+
+        using file_handle = std::unique_ptr<std::FILE, file_close>;
+
+        /**
+         * @brief Opens a file for unbuffered binary access: the sort does its own, larger buffering.
+         */
+        inline file_handle open_file(const std::filesystem::path& path, const char* mode)
+        {
+            file_handle f(std::fopen(path.string().c_str(), mode));
+            if (f)
+                std::setvbuf(f.get(), nullptr, _IONBF, 0);
+            return f;
+        }
+
+        /**
+         * @brief Reads records of a run through a buffer.
+         */
+        template<typename Tuple>
+        class run_reader
+        {
+        public:
+            run_reader(file_handle file, size_t buffer_records) : file_(std::move(file)), buffer_(buffer_records) { refill(); }
+
+            bool done() const noexcept { return position_ == count_; }
+            const Tuple& front() const noexcept { return buffer_.data()[position_]; }
+            bool failed() const noexcept { return failed_; }
+
+            void pop() noexcept
+            {
+                if (++position_ == count_)
+                    refill();
+            }
+
+        private:
+            void refill() noexcept
+            {
+                count_ = std::fread(buffer_.data(), sizeof(Tuple), buffer_.capacity(), file_.get());
+                failed_ |= count_ < buffer_.capacity() && std::ferror(file_.get());
+                position_ = 0;
+            }
+
+            file_handle file_;
+            record_buffer<Tuple> buffer_;
+            size_t position_ = 0;
+            size_t count_ = 0;
+            bool failed_ = false;
+        };
+
+        /**
+         * @brief Writes records through a buffer.
+         */
+        template<typename Tuple>
+        class run_writer
+        {
+        public:
+            run_writer(file_handle file, size_t buffer_records) : file_(std::move(file)), buffer_(buffer_records) {}
+
+
+            void push(const Tuple& record) noexcept
+            {
+                if (count_ == buffer_.capacity())
+                    flush();
+                std::memcpy(static_cast<void*>(buffer_.data() + count_++), &record, sizeof(Tuple));
+            }
+
+            /**
+             * @brief Writes the buffered records and closes the file.
+             *
+             * @return Whether every record was written.
+             */
+            bool close() noexcept
+            {
+                flush();
+                ok_ &= std::fclose(file_.release()) == 0;
+                return ok_;
+            }
+
+        private:
+            void flush() noexcept
+            {
+                ok_ &= std::fwrite(buffer_.data(), sizeof(Tuple), count_, file_.get()) == count_;
+                count_ = 0;
+            }
+
+            file_handle file_;
+            record_buffer<Tuple> buffer_;
+            size_t count_ = 0;
+            bool ok_ = true;
+        };
+
+        /**
+         * @brief A tournament tree of losers over k sorted sources.
+         *
+         * Node `n` in `[1, k)` holds the loser of the match between its children `2n` and `2n + 1`,
+         * and leaf `k + i` is source `i`; node 0 holds the source with the smallest record. After
+         * the winner advances, only its path to the root is replayed: one comparison per level,
+         * `log2(k)` in total, against `2 log2(k)` for a binary heap.
+         */
+        template<typename Tuple, typename Less>
+        class loser_tree
+        {
+        public:
+            loser_tree(std::vector<run_reader<Tuple>>& sources, const Less& less)
+                : sources_(sources), less_(less), k_(sources.size()), losers_(std::max<size_t>(k_, 1))
+            {
+                std::vector<size_t> winners(2 * k_);
+                for (size_t i = 0; i < k_; ++i)
+                    winners[k_ + i] = i;
+                for (size_t n = k_; n-- > 1;)
+                {
+                    const size_t a = winners[2 * n], b = winners[2 * n + 1];
+                    winners[n] = beats(a, b) ? a : b;
+                    losers_[n] = beats(a, b) ? b : a;
+                }
+                losers_[0] = k_ <= 1 ? 0 : winners[1]; // with no source, `done` holds from the start
+            }
+
+            bool done() const noexcept { return k_ == 0 || sources_[losers_[0]].done(); }
+            const Tuple& top() const noexcept { return sources_[losers_[0]].front(); }
+
+            /**
+             * @brief Advances the winning source and replays its matches.
+             */
+            void pop() noexcept
+            {
+                size_t winner = losers_[0];
+                sources_[winner].pop();
+                for (size_t n = (winner + k_) / 2; n >= 1; n /= 2)
+                    if (beats(losers_[n], winner))
+                        std::swap(losers_[n], winner);
+                losers_[0] = winner;
+            }
+
+        private:
+            /**
+             * @brief Whether source `a` wins against `b`: exhausted sources lose, ties go to the earlier run.
+             */
+            bool beats(size_t a, size_t b) const noexcept
+            {
+                if (sources_[a].done() != sources_[b].done())
+                    return sources_[b].done();
+                if (sources_[a].done())
+                    return a < b;
+                if (less_(sources_[a].front(), sources_[b].front()))
+                    return true;
+                return !less_(sources_[b].front(), sources_[a].front()) && a < b;
+            }
+
+            std::vector<run_reader<Tuple>>& sources_;
+            const Less& less_;
+            size_t k_;
+            std::vector<size_t> losers_;
+        };
+
+        /**
+         * @brief Stable merge sort of `[first, last)` through `scratch`, which holds at least half of the records, rounded up.
+         *
+         * Unlike `std::stable_sort`, it allocates nothing: each merge moves the left half into
+         * `scratch` and merges it with the right half back into place.
+         */
+        template<typename Tuple, typename Less>
+        void merge_sort(Tuple* first, Tuple* last, Tuple* scratch, const Less& less)
+        {
+            const size_t n = size_t(last - first);
+            if (n <= 16)
+            {
+                // Insertion sort, holding the record being placed in `scratch`.
+                for (Tuple* i = first + 1; i < last; ++i)
+                {
+                    if (!less(*i, *(i - 1)))
+                        continue;
+                    std::memcpy(static_cast<void*>(scratch), i, sizeof(Tuple));
+                    Tuple* j = i - 1;
+                    while (j != first && less(*scratch, *(j - 1)))
+                        --j;
+                    std::memmove(static_cast<void*>(j + 1), j, size_t(i - j) * sizeof(Tuple));
+                    std::memcpy(static_cast<void*>(j), scratch, sizeof(Tuple));
+                }
+                return;
+            }
+
+            Tuple* middle = first + n / 2;
+            merge_sort(first, middle, scratch, less);
+            merge_sort(middle, last, scratch, less);
+            if (!less(*middle, *(middle - 1)))
+                return;
+
+            // The output never overtakes the right half, which is read in place.
+            std::memcpy(static_cast<void*>(scratch), first, size_t(middle - first) * sizeof(Tuple));
+            const Tuple* left = scratch;
+            const Tuple* const left_end = scratch + (middle - first);
+            const Tuple* right = middle;
+            Tuple* out = first;
+            while (left != left_end && right != last)
+                std::memcpy(static_cast<void*>(out++), less(*right, *left) ? right++ : left++, sizeof(Tuple));
+            std::memcpy(static_cast<void*>(out), left, size_t(left_end - left) * sizeof(Tuple));
+        }
+
+        inline double seconds_since(std::chrono::steady_clock::time_point start) noexcept
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        /**
+         * @brief Merges runs into one file, dividing `budget` between one buffer per run and the output buffer.
+         */
+        template<typename Tuple, typename Less>
+        bool merge_runs(const std::vector<std::filesystem::path>& runs, const std::filesystem::path& output,
+            size_t budget, const Less& less, external_sort_stats& stats)
+        {
+            const size_t buffer_records = std::max<size_t>(1, budget / (runs.size() + 1) / sizeof(Tuple));
+            std::vector<run_reader<Tuple>> sources;
+            sources.reserve(runs.size());
+            for (const auto& run : runs)
+            {
+                file_handle f = open_file(run, "rb");
+                if (!f)
+                    return false;
+                sources.emplace_back(std::move(f), buffer_records);
+            }
+            file_handle out = open_file(output, "wb");
+            if (!out)
+                return false;
+            run_writer<Tuple> writer(std::move(out), buffer_records);
+            stats.peak_buffer_bytes = std::max(stats.peak_buffer_bytes, (runs.size() + 1) * buffer_records * sizeof(Tuple));
+
+            for (loser_tree<Tuple, Less> tree(sources, less); !tree.done(); tree.pop())
+                writer.push(tree.top());
+
+            bool ok = writer.close();
+            for (const auto& source : sources)
+                ok &= !source.failed();
+            return ok;
+        }
+
+        /**
+         * @brief Removes the files of a list when it goes out of scope, whether the sort succeeded or not.
+         */
+        struct temporary_files
+        {
+            std::vector<std::filesystem::path> paths;
+
+            ~temporary_files()
+            {
+                std::error_code ignored;
+                for (const auto& path : paths)
+                    std::filesystem::remove(path, ignored);
+            }
+        };
+    }//end of namespace detail
+
+    /**
+     * @brief Sorts a file of `Tuple` records by the elements at `Keys...` into another file.
+     *
+     * @param input A file of `Tuple` records, whose size must be a multiple of `sizeof(Tuple)`.
+     * @param output The sorted file; it must not be `input`.
+     * @return What the sort did, or `std::nullopt` if a file could not be read or written, or
+     * `input` is not a whole number of records.
+     */
+    template<typename Tuple, size_t... Keys>
+    std::optional<external_sort_stats> external_sort(const std::filesystem::path& input, const std::filesystem::path& output,
+        const external_sort_options& options = {})
+    {
+        static_assert(is_trivially_copyable_v<Tuple>, "records are read and written as bytes and must be trivially copyable");
+        static_assert(sizeof...(Keys) != 0, "at least one key element is required");
+
+        std::error_code error;
+        const std::uintmax_t input_bytes = std::filesystem::file_size(input, error);
+        if (error || input_bytes % sizeof(Tuple) != 0)
+            return std::nullopt;
+
+        const key_less<Keys...> less;
+        const size_t threads = options.threads != 0 ? options.threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+        const std::filesystem::path temp = options.temp_directory.empty() ? output.parent_path() : options.temp_directory;
+        const std::string stem = output.filename().string();
+
+        external_sort_stats stats;
+        stats.records = size_t(input_bytes / sizeof(Tuple));
+        detail::temporary_files runs;
+
+        // Run generation: one chunk is read while the previous ones are sorted and written. A thread's
+        // share of the budget holds its chunk and the scratch buffer of half a chunk that sorts it.
+        const auto run_start = std::chrono::steady_clock::now();
+        {
+            const size_t chunk_records = std::max<size_t>(1, options.memory_budget / threads / sizeof(Tuple) * 2 / 3);
+            detail::file_handle in = detail::open_file(input, "rb");
+            if (!in)
+                return std::nullopt;
+
+            struct slot
+            {
+                std::optional<detail::record_buffer<Tuple>> buffer;
+                std::optional<detail::record_buffer<Tuple>> scratch;
+                std::jthread worker;
+                bool ok = true;
+            };
+            std::vector<slot> slots(threads);
+            size_t allocated = 0;
+            bool ok = true;
+
+            for (size_t done = 0, next = 0; done < stats.records; next = (next + 1) % threads)
+            {
+                slot& s = slots[next];
+                if (s.worker.joinable())
+                    s.worker.join();
+                ok &= s.ok;
+                if (!s.buffer)
+                {
+                    s.buffer.emplace(std::min(chunk_records, stats.records - done));
+                    s.scratch.emplace((s.buffer->capacity() + 1) / 2);
+                    allocated += s.buffer->bytes() + s.scratch->bytes();
+                    stats.peak_buffer_bytes = std::max(stats.peak_buffer_bytes, allocated);
+                }
+
+                const size_t count = std::min(s.buffer->capacity(), stats.records - done);
+                if (std::fread(s.buffer->data(), sizeof(Tuple), count, in.get()) != count)
+                {
+                    ok = false;
+                    break;
+                }
+                done += count;
+
+                runs.paths.push_back(temp / (stem + ".run" + std::to_string(runs.paths.size())));
+                s.worker = std::jthread([&s, &less, count, path = runs.paths.back()]
+                    {
+                        Tuple* records = s.buffer->data();
+                        detail::merge_sort(records, records + count, s.scratch->data(), less);
+                        detail::file_handle out = detail::open_file(path, "wb");
+                        s.ok = out && std::fwrite(records, sizeof(Tuple), count, out.get()) == count && std::fclose(out.release()) == 0;
+                    });
+            }
+            for (slot& s : slots)
+            {
+                if (s.worker.joinable())
+                    s.worker.join();
+                ok &= s.ok;
+            }
+            if (!ok)
+                return std::nullopt;
+        }
+        stats.runs = runs.paths.size();
+        stats.run_seconds = detail::seconds_since(run_start);
+
+        // Merge: while there are more runs than buffers of `io_buffer` bytes fit in the budget,
+        // merge groups of them into longer runs.
+        const auto merge_start = std::chrono::steady_clock::now();
+        const size_t buffers = options.memory_budget / std::max(options.io_buffer, sizeof(Tuple)); // inputs and the output
+        const size_t fan_in = std::max<size_t>(2, buffers > 1 ? buffers - 1 : 0);
+        std::vector<std::filesystem::path> pending = runs.paths;
+        while (pending.size() > fan_in)
+        {
+            std::vector<std::filesystem::path> merged;
+            for (size_t begin = 0; begin < pending.size(); begin += fan_in)
+            {
+                const std::vector<std::filesystem::path> group(pending.begin() + begin,
+                    pending.begin() + std::min(pending.size(), begin + fan_in));
+                runs.paths.push_back(temp / (stem + ".run" + std::to_string(runs.paths.size())));
+                if (!detail::merge_runs<Tuple>(group, runs.paths.back(), options.memory_budget, less, stats))
+                    return std::nullopt;
+                merged.push_back(runs.paths.back());
+                for (const auto& path : group)
+                    std::filesystem::remove(path, error);
+            }
+            pending = std::move(merged);
+            ++stats.merge_passes;
+        }
+        if (!detail::merge_runs<Tuple>(pending, output, options.memory_budget, less, stats))
+            return std::nullopt;
+        ++stats.merge_passes;
+        stats.merge_seconds = detail::seconds_since(merge_start);
+        return stats;
+    }
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <string_view>
+
+#include "helper_.h"
+
+namespace metakit
+{
+    /**
+     * @brief A string literal that can be used as a non-type template parameter.
+     *
+     * The characters are stored inline (including the terminating null), which makes
+     * the type structural and lets `"name"` appear directly in a template argument list.
+     *
+     * @tparam N The size of the literal including the terminating null character.
+     */
+    template<size_t N>
+    struct fixed_string
+    {
+        char value[N]{}; ///< The characters of the literal, null terminated.
+
+        /**
+         * @brief Copies a string literal into the fixed string.
+         *
+         * @param str The literal to copy.
+         */
+        constexpr fixed_string(const char (&str)[N]) noexcept
+        {
+            for (size_t i = 0; i < N; ++i)
+                value[i] = str[i];
+        }
+
+        /**
+         * @brief Retrieves the number of characters, excluding the terminating null.
+         */
+        static constexpr size_t size() noexcept { return N - 1; }
+
+        /**
+         * @brief Views the characters as a `std::string_view`.
+         */
+        constexpr std::string_view view() const noexcept { return { value, N - 1 }; }
+
+        constexpr operator std::string_view() const noexcept { return view(); }
+
+        /**
+         * @brief Compares two fixed strings of possibly different lengths.
+         */
+        template<size_t M>
+        constexpr bool operator==(const fixed_string<M>& other) const noexcept
+        {
+            return view() == other.view();
+        }
+    };
+
+    /**
+     * @brief Deduction guide for constructing a fixed string from a literal.
+     */
+    template<size_t N>
+    fixed_string(const char (&)[N]) -> fixed_string<N>;
+}
+
+#endif
@@ -1,6 +1,63 @@
 #ifndef HELPER__H
 #define HELPER__H
 
+#include <cstddef>
+
+/**
+ * @brief Evaluates `__has_builtin(x)` on compilers that provide it and 0 elsewhere.
+ *
+ * Defining it to 0 before including MetaKit forces the portable fallbacks.
+ */
+#ifndef METAKIT_HAS_BUILTIN
+#ifdef __has_builtin
+#define METAKIT_HAS_BUILTIN(x) __has_builtin(x)
+#else
+#define METAKIT_HAS_BUILTIN(x) 0
+#endif
+#endif
+
+#if !METAKIT_HAS_BUILTIN(__is_trivially_copyable) || !METAKIT_HAS_BUILTIN(__is_empty) || !METAKIT_HAS_BUILTIN(__is_base_of)
+// The fallbacks of the traits that cannot be written in the language itself.
+#include <type_traits>
+#endif
+
+/**
+ * @brief Inlines a function even in unoptimized builds.
+ *
+ * GCC and Clang honour `always_inline` at -O0. MSVC does not inline at /Od; there the
+ * pure casts are additionally marked `METAKIT_INTRINSIC`.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define METAKIT_ALWAYS_INLINE [[gnu::always_inline]] inline
+#elif defined(_MSC_VER)
+#define METAKIT_ALWAYS_INLINE __forceinline
+#else
+#define METAKIT_ALWAYS_INLINE inline
+#endif
+
+/**
+ * @brief Keeps a cold function out of line so that it does not bloat its hot callers.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define METAKIT_NOINLINE [[gnu::noinline]]
+#elif defined(_MSC_VER)
+#define METAKIT_NOINLINE __declspec(noinline)
+#else
+#define METAKIT_NOINLINE
+#endif
+
+/**
+ * @brief Lets MSVC replace a function whose body is a single cast by the cast itself, even at /Od.
+ */
+#if defined(_MSC_VER) && defined(__has_cpp_attribute)
+#if __has_cpp_attribute(msvc::intrinsic)
+#define METAKIT_INTRINSIC [[msvc::intrinsic]]
+#endif
+#endif
+#ifndef METAKIT_INTRINSIC
+#define METAKIT_INTRINSIC
+#endif
+
 namespace metakit
 {
     /**
@@ -35,9 +92,6 @@ namespace metakit
     template <typename THEN, typename ELSE>
     struct if_<false, THEN, ELSE> : has_type<ELSE> {};
 
-    static_assert(std::is_same_v<typename if_<(10 > 5), int, bool>::type, int>);
-    static_assert(std::is_same_v<typename if_<(10 < 5), int, bool>::type, bool>);
-
     /**
      * @brief Represents a constant integral value as a type.
      *
@@ -62,6 +116,13 @@ namespace metakit
     template<bool T>
     using bool_constant = integral_constant<bool, T>;
 
+#if METAKIT_HAS_BUILTIN(__is_same)
+    /**
+     * @brief Checks if two types are the same, using the compiler builtin.
+     */
+    template <typename T1, typename T2>
+    static constexpr bool is_same_v = __is_same(T1, T2);
+#else
     /**
      * @brief Checks if two types are the same.
      */
@@ -73,6 +134,7 @@ namespace metakit
      */
     template<typename T1>
     static constexpr bool is_same_v<T1, T1> = true;
+#endif
 
     /**
      * @brief Boolean trait to determine if two types are the same.
@@ -134,11 +196,6 @@ namespace metakit
     template<typename T>
     using strip_pointer_t = typename strip_pointer<T>::type;
 
-    /**
-     * @brief Static assertion to ensure `strip_pointer_t<int*>` correctly reduces to `int`.
-     */
-    static_assert(std::is_same_v<strip_pointer_t<int*>, int>);
-
     /**
      * @brief Primary template for removing const and volatile qualifiers from a type.
      *
@@ -217,8 +274,13 @@ namespace metakit
      *
      * @tparam T The type to process.
      */
+#if METAKIT_HAS_BUILTIN(__remove_cv)
+    template<typename T>
+    using remove_cv_t = __remove_cv(T);
+#else
     template<typename T>
     using remove_cv_t = typename remove_cv<T>::type;
+#endif
 
     /**
      * @brief Removes references from types and provides constant reference equivalents.
@@ -254,8 +316,16 @@ namespace metakit
      *
      * @tparam T The type to process.
      */
+#if METAKIT_HAS_BUILTIN(__remove_reference_t)
+    template<typename T>
+    using remove_refernce_t = __remove_reference_t(T);
+#elif METAKIT_HAS_BUILTIN(__remove_reference)
+    template<typename T>
+    using remove_refernce_t = __remove_reference(T);
+#else
     template<typename T>
     using remove_refernce_t = typename remove_reference<T>::type;
+#endif
 
     /**
      * @brief Alias for getting a constant reference type after removing references.
@@ -265,13 +335,34 @@ namespace metakit
     template<typename T>
     using const_through_ref = typename remove_reference<T>::const_ref;
 
+    /**
+     * @brief Alias removing references and then const/volatile qualifiers from a type.
+     *
+     * @tparam T The type to process.
+     */
+#if METAKIT_HAS_BUILTIN(__remove_cvref)
+    template<typename T>
+    using remove_cvref_t = __remove_cvref(T);
+#else
+    template<typename T>
+    using remove_cvref_t = remove_cv_t<remove_refernce_t<T>>;
+#endif
+
+    /**
+     * @brief Removes references and then const/volatile qualifiers from a type.
+     *
+     * @tparam T The type to process.
+     */
+    template<typename T>
+    struct remove_cvref : has_type<remove_cvref_t<T>> {};
+
     /**
      * @brief Removes references and const/volatile qualifiers from types.
      *
      * @tparam T The type to process.
      */
     template<typename T>
-    using Remove_cvrf_t = typename remove_cv<remove_refernce_t<T>>::type;
+    using Remove_cvrf_t = remove_cvref_t<T>;
 
     /**
      * @brief Alias for consistent naming in removing references and qualifiers.
@@ -370,7 +461,7 @@ namespace metakit
      * @return The forwarded lvalue as an rvalue reference.
      */
     template<typename T>
-    constexpr T&& forward(remove_refernce_t<T>& args) noexcept
+    METAKIT_INTRINSIC METAKIT_ALWAYS_INLINE constexpr T&& forward(remove_refernce_t<T>& args) noexcept
     {
         return static_cast<T&&>(args);
     }
@@ -387,7 +478,7 @@ namespace metakit
      */
     template<typename T>
     requires(is_rvalue_reference_v<T>)//added in c++20
-    constexpr T&& forward(remove_refernce_t<T>&& args) noexcept
+    METAKIT_INTRINSIC METAKIT_ALWAYS_INLINE constexpr T&& forward(remove_refernce_t<T>&& args) noexcept
     {
         return static_cast<T&&>(args);
     }
@@ -400,7 +491,7 @@ namespace metakit
      * @return An rvalue reference to the object, enabling ownership transfer.
      */
     template<typename T>
-    constexpr remove_refernce_t<T>&& move(T&& args) noexcept
+    METAKIT_INTRINSIC METAKIT_ALWAYS_INLINE constexpr remove_refernce_t<T>&& move(T&& args) noexcept
     {
         return static_cast<remove_refernce_t<T>&&>(args);
     }
@@ -415,16 +506,48 @@ namespace metakit
     template<typename T, typename...Ts>
     constexpr bool is_any_of = (is_same_v<T, Ts> || ...);
 
+    namespace detail
+    {
+        /**
+         * @brief Portable integral check with one specialization per integral type.
+         *
+         * A query is a single specialization lookup instead of a comparison against every
+         * integral type.
+         */
+        template<typename T>
+        constexpr bool is_integral_base = false;
+
+        template<> constexpr bool is_integral_base<bool> = true;
+        template<> constexpr bool is_integral_base<char> = true;
+        template<> constexpr bool is_integral_base<signed char> = true;
+        template<> constexpr bool is_integral_base<unsigned char> = true;
+        template<> constexpr bool is_integral_base<wchar_t> = true;
+        template<> constexpr bool is_integral_base<char8_t> = true;
+        template<> constexpr bool is_integral_base<char16_t> = true;
+        template<> constexpr bool is_integral_base<char32_t> = true;
+        template<> constexpr bool is_integral_base<short> = true;
+        template<> constexpr bool is_integral_base<unsigned short> = true;
+        template<> constexpr bool is_integral_base<int> = true;
+        template<> constexpr bool is_integral_base<unsigned int> = true;
+        template<> constexpr bool is_integral_base<long> = true;
+        template<> constexpr bool is_integral_base<unsigned long> = true;
+        template<> constexpr bool is_integral_base<long long> = true;
+        template<> constexpr bool is_integral_base<unsigned long long> = true;
+    }
+
     /**
      * @brief Checks if a type T is an integral type.
      *
-     * This is a specialization of the `is_any_of` template to check if T is any of
-     * the predefined integral types such as bool, char, int, long, etc.
+     * References and cv-qualifiers are ignored, so `const int&` is integral.
+     * Uses the `__is_integral` builtin when the compiler provides it.
      */
+#if METAKIT_HAS_BUILTIN(__is_integral)
     template<typename T>
-    constexpr bool is_integral_v = is_any_of<remove_cvrf_t<T>, bool, char, signed char, unsigned char, wchar_t, char8_t,
-        char16_t, char32_t, short, unsigned short, int, unsigned int,
-        long, unsigned long, long long, unsigned long long>;
+    constexpr bool is_integral_v = __is_integral(remove_cvref_t<T>);
+#else
+    template<typename T>
+    constexpr bool is_integral_v = detail::is_integral_base<remove_cvref_t<T>>;
+#endif
 
     /**
      * @brief Type trait to check if a type T is integral.
@@ -436,6 +559,64 @@ namespace metakit
     template<typename T>
     struct is_integral : bool_constant<is_integral_v<T>> {};
 
+    /**
+     * @brief Checks if objects of a type can be copied with `memcpy`.
+     *
+     * The property cannot be computed in the language itself, so without the builtin this
+     * defers to the standard library.
+     */
+#if METAKIT_HAS_BUILTIN(__is_trivially_copyable)
+    template<typename T>
+    constexpr bool is_trivially_copyable_v = __is_trivially_copyable(T);
+#else
+    template<typename T>
+    constexpr bool is_trivially_copyable_v = std::is_trivially_copyable_v<T>;
+#endif
+
+    /**
+     * @brief Type trait to check if a type is trivially copyable.
+     */
+    template<typename T>
+    struct is_trivially_copyable : bool_constant<is_trivially_copyable_v<T>> {};
+
+    /**
+     * @brief Checks if a class type has no non-static data members and no virtual functions or bases.
+     *
+     * Backed by the `__is_empty` builtin where available, and by the standard library elsewhere.
+     */
+#if METAKIT_HAS_BUILTIN(__is_empty)
+    template<typename T>
+    constexpr bool is_empty_v = __is_empty(T);
+#else
+    template<typename T>
+    constexpr bool is_empty_v = std::is_empty_v<T>;
+#endif
+
+    /**
+     * @brief Type trait to check if a class type is empty.
+     */
+    template<typename T>
+    struct is_empty : bool_constant<is_empty_v<T>> {};
+
+    /**
+     * @brief Checks if `Base` is a base class of (or the same class as) `Derived`.
+     *
+     * Backed by the `__is_base_of` builtin where available, and by the standard library elsewhere.
+     */
+#if METAKIT_HAS_BUILTIN(__is_base_of)
+    template<typename Base, typename Derived>
+    constexpr bool is_base_of_v = __is_base_of(Base, Derived);
+#else
+    template<typename Base, typename Derived>
+    constexpr bool is_base_of_v = std::is_base_of_v<Base, Derived>;
+#endif
+
+    /**
+     * @brief Type trait to check if a class is a base of another.
+     */
+    template<typename Base, typename Derived>
+    struct is_base_of : bool_constant<is_base_of_v<Base, Derived>> {};
+
     /** 
     * @brief A structure to represent a sequence of integral values as a compile-time type.
     *
@@ -466,11 +647,19 @@ namespace metakit
 	/**
 	 * @brief Alias template for creating an integer sequence.
 	 *
+	 * Uses `__make_integer_seq` (MSVC, Clang) or `__integer_pack` (GCC), so the sequence is
+	 * built without recursive instantiations.
+	 *
 	 * @tparam T The integral type of the sequence.
 	 * @tparam Ts The values in the sequence.
 	 */
+#if defined(__GNUC__) && !defined(__clang__)
+    template<typename T, T Size>
+    using make_integer_sequence = integer_sequence<T, __integer_pack(Size)...>;
+#else
     template<typename T, T Size>
     using make_integer_sequence = __make_integer_seq<integer_sequence,T, Size>;
+#endif
 
 	/**
 	 * @brief Alias template for creating an integer sequence.
@@ -0,0 +1,223 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "helper_.h"
+#include "per_thread.h"
+
+namespace metakit
+{
+    /**
+     * @brief Log-linear bucket layout of a histogram, computed at compile time.
+     *
+     * Values below `2^PrecisionBits` get a bucket each; above, every power of two is split
+     * into `2^PrecisionBits` equal buckets, so a bucket is never wider than `2^-PrecisionBits`
+     * of the values it holds. Values above `Highest` are counted in the last bucket.
+     *
+     * @tparam Highest The largest value that is told apart from larger ones.
+     * @tparam PrecisionBits The number of significant bits kept of every value.
+     */
+    template <std::uint64_t Highest, unsigned PrecisionBits = 7>
+    struct histogram_layout
+    {
+        static_assert(PrecisionBits >= 1 && PrecisionBits <= 24, "histogram precision must be 1 to 24 bits");
+
+        static constexpr std::uint64_t highest = Highest;       ///< The largest distinguished value.
+        static constexpr unsigned precision_bits = PrecisionBits; ///< The significant bits kept.
+
+        /**
+         * @brief Retrieves the bucket of a value: a clamp, a bit scan, a shift and an add.
+         */
+        METAKIT_ALWAYS_INLINE static constexpr size_t index_of(std::uint64_t value) noexcept
+        {
+            value = value < Highest ? value : Highest;
+            const unsigned shift = unsigned(std::bit_width(value | sub_bucket_count)) - 1 - PrecisionBits;
+            return (size_t(shift) << PrecisionBits) + size_t(value >> shift);
+        }
+
+        static constexpr size_t bucket_count = index_of(Highest) + 1; ///< The number of buckets.
+
+        /**
+         * @brief Retrieves the smallest value that falls into a bucket.
+         */
+        static constexpr std::uint64_t lowest_in(size_t index) noexcept
+        {
+            const unsigned shift = shift_of(index);
+            return std::uint64_t(index - (size_t(shift) << PrecisionBits)) << shift;
+        }
+
+        /**
+         * @brief Retrieves the largest value that falls into a bucket.
+         */
+        static constexpr std::uint64_t highest_in(size_t index) noexcept
+        {
+            return lowest_in(index) + (std::uint64_t(1) << shift_of(index)) - 1;
+        }
+
+    private:
+        static constexpr std::uint64_t sub_bucket_count = std::uint64_t(1) << PrecisionBits;
+
+        static constexpr unsigned shift_of(size_t index) noexcept
+        {
+            const size_t power = index >> PrecisionBits;
+            return power == 0 ? 0 : unsigned(power - 1);
+        }
+    };
+
+    /**
+     * @brief Counts of values per bucket of a compile-time `histogram_layout`.
+     *
+     * Recording is meant for a single thread; it is a relaxed load and store of the bucket, so
+     * that other threads can `merge` or query the histogram at the same time without a lock.
+     *
+     * @tparam Layout A `histogram_layout`.
+     */
+    template <typename Layout>
+    class histogram
+    {
+    public:
+        using layout = Layout; ///< The bucket layout.
+
+        /**
+         * @brief Counts one value, or `n` equal values.
+         */
+        METAKIT_ALWAYS_INLINE void record(std::uint64_t value, std::uint64_t n = 1) noexcept
+        {
+            std::atomic_ref<std::uint64_t> bucket(counts[Layout::index_of(value)]);
+            bucket.store(bucket.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Adds the counts of another histogram, which may be recording concurrently.
+         */
+        void merge(const histogram& other) noexcept
+        {
+            for (size_t i = 0; i < Layout::bucket_count; ++i)
+                counts[i] += std::atomic_ref<const std::uint64_t>(other.counts[i]).load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Retrieves the number of values in a bucket.
+         */
+        std::uint64_t count_at(size_t index) const noexcept
+        {
+            return std::atomic_ref<const std::uint64_t>(counts[index]).load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Retrieves the number of recorded values.
+         */
+        std::uint64_t count() const noexcept
+        {
+            std::uint64_t total = 0;
+            for (size_t i = 0; i < Layout::bucket_count; ++i)
+                total += count_at(i);
+            return total;
+        }
+
+        /**
+         * @brief Retrieves the value below or at which `percentile` percent of the recorded values lie.
+         *
+         * The result is the highest value of the bucket it falls into, so it overestimates by
+         * less than `2^-PrecisionBits` relative. Zero if nothing was recorded.
+         */
+        std::uint64_t value_at_percentile(double percentile) const noexcept
+        {
+            const std::uint64_t total = count();
+            if (total == 0)
+                return 0;
+            percentile = percentile < 0 ? 0 : percentile > 100 ? 100 : percentile;
+            std::uint64_t rank = std::uint64_t(percentile / 100.0 * double(total) + 0.5);
+            rank = rank == 0 ? 1 : rank > total ? total : rank;
+
+            std::uint64_t seen = 0;
+            for (size_t i = 0; i < Layout::bucket_count; ++i)
+            {
+                seen += count_at(i);
+                if (seen >= rank)
+                    return Layout::highest_in(i);
+            }
+            return Layout::highest_in(Layout::bucket_count - 1);
+        }
+
+        /**
+         * @brief Retrieves the mean of the recorded values, taking every value as the middle of its bucket.
+         */
+        double mean() const noexcept
+        {
+            double sum = 0;
+            std::uint64_t total = 0;
+            for (size_t i = 0; i < Layout::bucket_count; ++i)
+            {
+                const std::uint64_t n = count_at(i);
+                sum += double(n) * (double(Layout::lowest_in(i)) + double(Layout::highest_in(i))) / 2;
+                total += n;
+            }
+            return total == 0 ? 0 : sum / double(total);
+        }
+
+        /**
+         * @brief Clears all counts; only exact while nothing records concurrently.
+         */
+        void reset() noexcept
+        {
+            for (auto& c : counts)
+                std::atomic_ref<std::uint64_t>(c).store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::uint64_t, Layout::bucket_count> counts{};
+    };
+
+    /**
+     * @brief One histogram per recording thread, merged on demand without locks.
+     *
+     * `record` finds the calling thread's histogram through `per_thread`, so a thread that
+     * records into the same set repeatedly pays one comparison on top of `histogram::record`.
+     * The counts of exited threads are kept, and a thread keeps nothing per set, so a
+     * long-lived worker may record into one set per request. The set must outlive its recording.
+     *
+     * @tparam Layout A `histogram_layout`.
+     */
+    template <typename Layout>
+    class thread_histograms
+    {
+    public:
+        using histogram_type = histogram<Layout>; ///< The per-thread histogram.
+
+        /**
+         * @brief Retrieves the calling thread's histogram, creating it on first use.
+         */
+        histogram_type& local()
+        {
+            return threads.local();
+        }
+
+        /**
+         * @brief Counts a value in the calling thread's histogram.
+         */
+        METAKIT_ALWAYS_INLINE void record(std::uint64_t value, std::uint64_t n = 1)
+        {
+            local().record(value, n);
+        }
+
+        /**
+         * @brief Sums the histograms of all threads.
+         */
+        histogram_type merged() const noexcept
+        {
+            histogram_type result;
+            threads.for_each([&](const histogram_type& h) { result.merge(h); });
+            return result;
+        }
+
+    private:
+        per_thread<histogram_type> threads;
+    };
+}
+
+#endif
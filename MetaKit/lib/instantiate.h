@@ -0,0 +1,48 @@
+#ifndef INSTANTIATE_H
+#define INSTANTIATE_H
+
+#include "type_list.h"
+
+/**
+ * @brief Helpers for instantiating a class template once per type of a list.
+ *
+ * The types are given as an X-macro taking a callback and an argument:
+ *
+ *     #define KERNEL_TYPES(X, arg) X(arg, int) X(arg, double) X(arg, order)
+ *
+ * A header declares `METAKIT_EXTERN_TEMPLATES(kernel, KERNEL_TYPES)` so that no including
+ * translation unit instantiates `kernel<T>` on its own, and the explicit instantiations
+ * `METAKIT_INSTANTIATE_TEMPLATES(kernel, KERNEL_TYPES)` are compiled elsewhere, split into
+ * shards that build in parallel (tools/instantiation_shards.py generates them).
+ *
+ * Member functions defined inside the class body are inline, and compilers may still
+ * instantiate inline functions of an `extern template` for inlining. Define the heavy
+ * members outside the class so that only the shards compile them.
+ *
+ * Types containing a top-level comma must be passed through an alias.
+ */
+
+#define METAKIT_DETAIL_EXTERN_TEMPLATE(tmpl, T) extern template struct tmpl<T>;
+#define METAKIT_DETAIL_INSTANTIATE_TEMPLATE(tmpl, T) template struct tmpl<T>;
+#define METAKIT_DETAIL_LIST_ELEMENT(unused, T) , T
+
+/**
+ * @brief Declares `extern template struct tmpl<T>;` for every type of the X-macro `types`.
+ */
+#define METAKIT_EXTERN_TEMPLATES(tmpl, types) types(METAKIT_DETAIL_EXTERN_TEMPLATE, tmpl)
+
+/**
+ * @brief Defines `template struct tmpl<T>;` for every type of the X-macro `types`.
+ */
+#define METAKIT_INSTANTIATE_TEMPLATES(tmpl, types) types(METAKIT_DETAIL_INSTANTIATE_TEMPLATE, tmpl)
+
+/**
+ * @brief Names the `type_list` holding the types of the X-macro `types`, in order.
+ *
+ * Lets code that iterates over the instantiated types share the X-macro as its single
+ * source of truth.
+ */
+#define METAKIT_TYPE_LIST(types) \
+    ::metakit::pop_front_t<::metakit::type_list<void types(METAKIT_DETAIL_LIST_ELEMENT, ~)>>
+
+#endif
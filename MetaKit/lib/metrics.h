@@ -0,0 +1,206 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+#include "type_list.h"
+
+namespace metakit
+{
+    /**
+     * @brief Counters identified by tag types instead of strings.
+     *
+     * Every tag gets a compile-time slot (its position in the list), and every thread counts
+     * into its own cache-line-aligned array of slots. `inc<Tag>()` is therefore one relaxed
+     * load-add-store on a line no other thread writes: no hashing, no lock prefix, no call.
+     * The first increment on a thread attaches its array to a registry, which `collect` and
+     * the `aggregator` sum over; a thread's counts are folded into the totals when it exits.
+     *
+     * All state is static, so the counters of one tag list are shared by the whole program.
+     *
+     * @tparam Tags A `type_list` of distinct tag types.
+     */
+    template <typename Tags>
+    class metrics;
+
+    template <typename... Tags>
+    class metrics<type_list<Tags...>>
+    {
+    public:
+        using tags = type_list<Tags...>; ///< The tag types, in slot order.
+
+        static constexpr size_t size = sizeof...(Tags); ///< The number of counters.
+
+        static_assert(detail::has_unique_types<tags>::value, "metrics tags must be distinct");
+
+        /**
+         * @brief The slot of a tag, i.e. its position in the tag list.
+         */
+        template <typename Tag>
+        static constexpr size_t slot = [] {
+            static_assert(index_of_v<Tag, tags> < size, "tag is not part of this metrics list");
+            return index_of_v<Tag, tags>;
+        }();
+
+        /**
+         * @brief The value of every counter at one point in time.
+         */
+        struct snapshot
+        {
+            std::array<std::uint64_t, size> values{};            ///< The totals, indexed by slot.
+            std::chrono::steady_clock::time_point taken_at{};   ///< When the totals were summed.
+
+            template <typename Tag>
+            std::uint64_t get() const noexcept { return values[slot<Tag>]; }
+        };
+
+        /**
+         * @brief Adds `n` to the counter of `Tag` on the calling thread.
+         */
+        template <typename Tag>
+        static void inc(std::uint64_t n = 1) noexcept
+        {
+            if (!local.attached) [[unlikely]]
+                attach();
+            std::atomic_ref<std::uint64_t> counter(local.counts[slot<Tag>]);
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Sums the counters of all threads, including threads that have exited.
+         *
+         * Takes the registry lock, which only thread start and exit contend for; incrementing
+         * threads are never blocked.
+         */
+        static snapshot collect()
+        {
+            snapshot result;
+            std::lock_guard lock(registry_mutex);
+            result.values = retired;
+            for (block* b = registry; b != nullptr; b = b->next)
+                for (size_t i = 0; i < size; ++i)
+                    result.values[i] += std::atomic_ref<std::uint64_t>(b->counts[i]).load(std::memory_order_relaxed);
+            result.taken_at = std::chrono::steady_clock::now();
+            return result;
+        }
+
+        /**
+         * @brief Background thread taking a snapshot at a fixed interval.
+         */
+        class aggregator
+        {
+        public:
+            /**
+             * @param interval The time between two snapshots.
+             * @param on_snapshot Called on the aggregator thread with every snapshot; may be empty.
+             */
+            explicit aggregator(std::chrono::nanoseconds interval, std::function<void(const snapshot&)> on_snapshot = {})
+                : period(interval), callback(metakit::move(on_snapshot)),
+                  worker([this](std::stop_token stop) { run(stop); }) {}
+
+            aggregator(const aggregator&) = delete;
+            aggregator& operator=(const aggregator&) = delete;
+
+            /**
+             * @brief Retrieves the most recent snapshot; all zero before the first one.
+             */
+            snapshot latest() const
+            {
+                std::lock_guard lock(latest_mutex);
+                return last;
+            }
+
+            /**
+             * @brief Retrieves how many snapshots have been taken.
+             */
+            std::uint64_t snapshots_taken() const noexcept { return taken.load(std::memory_order_relaxed); }
+
+        private:
+            void run(std::stop_token stop)
+            {
+                std::mutex wait_mutex;
+                std::condition_variable_any wakeup;
+                while (!stop.stop_requested())
+                {
+                    const snapshot s = collect();
+                    {
+                        std::lock_guard lock(latest_mutex);
+                        last = s;
+                    }
+                    taken.fetch_add(1, std::memory_order_relaxed);
+                    if (callback)
+                        callback(s);
+
+                    std::unique_lock lock(wait_mutex);
+                    wakeup.wait_for(lock, stop, period, [] { return false; });
+                }
+            }
+
+            std::chrono::nanoseconds period;
+            std::function<void(const snapshot&)> callback;
+            mutable std::mutex latest_mutex;
+            snapshot last;
+            std::atomic<std::uint64_t> taken{ 0 };
+            std::jthread worker; ///< Declared last so that it stops before the members it uses are destroyed.
+        };
+
+    private:
+        static constexpr size_t line_size = 64;
+        static constexpr size_t padded_size = (size * sizeof(std::uint64_t) + line_size - 1) / line_size * line_size / sizeof(std::uint64_t);
+
+        /**
+         * @brief The counters of one thread; constant-initialized so that access needs no guard.
+         */
+        struct alignas(line_size) block
+        {
+            std::uint64_t counts[padded_size == 0 ? 1 : padded_size]{};
+            bool attached = false;
+            block* prev = nullptr;
+            block* next = nullptr;
+        };
+
+        /**
+         * @brief Detaches the thread's block at thread exit and keeps its counts.
+         */
+        struct detacher
+        {
+            ~detacher()
+            {
+                std::lock_guard lock(registry_mutex);
+                for (size_t i = 0; i < size; ++i)
+                    retired[i] += local.counts[i];
+                (local.prev ? local.prev->next : registry) = local.next;
+                if (local.next)
+                    local.next->prev = local.prev;
+            }
+        };
+
+        METAKIT_NOINLINE static void attach()
+        {
+            {
+                std::lock_guard lock(registry_mutex);
+                local.next = registry;
+                if (registry)
+                    registry->prev = &local;
+                registry = &local;
+                local.attached = true;
+            }
+            thread_local detacher on_exit;
+        }
+
+        static inline thread_local block local;
+        static inline std::mutex registry_mutex;
+        static inline block* registry = nullptr;
+        static inline std::array<std::uint64_t, size> retired{};
+    };
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef NAMED_TUPLE_H
+#define NAMED_TUPLE_H
+
+#include <array>
+#include <string_view>
+
+#include "fixed_string.h"
+#include "tuple.h"
+
+namespace metakit
+{
+    /**
+     * @brief Describes a named element of a `named_tuple`.
+     *
+     * @tparam Name The compile-time name of the field.
+     * @tparam T The type stored for the field.
+     */
+    template<fixed_string Name, typename T>
+    struct field
+    {
+        static constexpr auto name = Name; ///< The name of the field.
+        using type = T;                    ///< The type stored for the field.
+    };
+
+    /**
+     * @brief A tuple whose elements are additionally addressable by name.
+     *
+     * The names only exist at compile time: a `named_tuple` derives from the positional
+     * `tuple` of its field types, so its storage and layout are exactly those of that tuple
+     * and `get<"name">` resolves to the same constant offset as `get<index>`.
+     *
+     * @tparam Fields The `field` descriptors, in positional order.
+     */
+    template<typename... Fields>
+    struct named_tuple : tuple<typename Fields::type...>
+    {
+        using tuple_type = tuple<typename Fields::type...>; ///< The positional tuple providing the storage.
+
+        using tuple_type::tuple_type;
+
+        /**
+         * @brief The field names in positional order, for serializers and diagnostics.
+         */
+        static constexpr std::array<std::string_view, sizeof...(Fields)> names{ Fields::name.view()... };
+
+        /**
+         * @brief Computes the position of the field called `Name`.
+         *
+         * Yields `sizeof...(Fields)` when there is no such field.
+         */
+        template<fixed_string Name>
+        static constexpr size_t index_of = []
+        {
+            size_t i = 0;
+            while (i < names.size() && names[i] != Name.view())
+                ++i;
+            return i;
+        }();
+
+        /**
+         * @brief Provides access to the positional tuple providing the storage.
+         */
+        constexpr tuple_type& as_tuple() & noexcept { return *this; }
+        constexpr const tuple_type& as_tuple() const& noexcept { return *this; }
+        constexpr tuple_type&& as_tuple() && noexcept { return static_cast<tuple_type&&>(*this); }
+        constexpr const tuple_type&& as_tuple() const&& noexcept { return static_cast<const tuple_type&&>(*this); }
+
+    private:
+        static constexpr bool has_unique_names = []
+        {
+            for (size_t i = 0; i < names.size(); ++i)
+                for (size_t j = i + 1; j < names.size(); ++j)
+                    if (names[i] == names[j])
+                        return false;
+            return true;
+        }();
+
+        static_assert(has_unique_names, "named_tuple field names must be unique");
+    };
+
+    /**
+     * @brief Trait to check if a type is a `named_tuple`.
+     */
+    template<typename T>
+    struct is_named_tuple : false_type {};
+
+    /**
+     * @brief Specialization for `named_tuple` types.
+     */
+    template<typename... Fields>
+    struct is_named_tuple<named_tuple<Fields...>> : true_type {};
+
+    /**
+     * @brief Boolean constant to check if a type is a `named_tuple`.
+     */
+    template<typename T>
+    static constexpr bool is_named_tuple_v = is_named_tuple<T>::value;
+
+    namespace detail
+    {
+        /**
+         * @brief Size of a named tuple, which is the number of its fields.
+         */
+        template<typename... Fields>
+        struct tuple_size<named_tuple<Fields...>> : integral_constant<size_t, sizeof...(Fields)> {};
+
+        /**
+         * @brief Positional access into a named tuple is positional access into its storage tuple.
+         */
+        template<size_t i, typename... Fields>
+        struct get_impl<i, named_tuple<Fields...>> : get_impl<i, tuple<typename Fields::type...>> {};
+
+        /**
+         * @brief Disambiguates index 0 between the named tuple and the first-element specializations.
+         */
+        template<typename... Fields>
+        struct get_impl<0, named_tuple<Fields...>> : get_impl<0, tuple<typename Fields::type...>> {};
+    }
+
+    /**
+     * @brief Retrieves the type of the element at index `i` in a named tuple.
+     */
+    template<size_t i, typename... Fields>
+    struct tuple_element<i, named_tuple<Fields...>> : tuple_element<i, tuple<typename Fields::type...>> {};
+
+    /**
+     * @brief Retrieves the type of the field called `Name` in a named tuple.
+     *
+     * @tparam Name The name of the field.
+     * @tparam NamedTuple The named tuple type being accessed.
+     */
+    template<fixed_string Name, typename NamedTuple>
+    using field_t = tuple_element_t<NamedTuple::template index_of<Name>, NamedTuple>;
+
+    /**
+     * @brief Retrieves the field called `Name` from a named tuple.
+     *
+     * The name is resolved to an index at compile time, so this is exactly `get<index>`.
+     *
+     * @tparam Name The name of the field.
+     * @tparam NamedTuple The named tuple type being accessed.
+     * @param t The named tuple instance.
+     * @return The field, adjusted for reference and const-ness like `get<index>`.
+     */
+    template<fixed_string Name, typename NamedTuple>
+    requires(is_named_tuple_v<remove_cvrf_t<NamedTuple>>)
+    constexpr decltype(auto) get(NamedTuple&& t)
+    {
+        using named_t = remove_cvrf_t<NamedTuple>;
+        constexpr size_t index = named_t::template index_of<Name>;
+        static_assert(index < detail::tuple_size_v<named_t>, "named_tuple has no field with this name");
+
+        return get<index>(metakit::forward<NamedTuple>(t));
+    }
+}
+
+#endif
@@ -0,0 +1,422 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "tuple.h"
+
+namespace metakit
+{
+    /**
+     * @brief Result of a parser that matches input without producing a value.
+     *
+     * `seq` drops `unit` results at compile time, the same way `filter` drops elements.
+     */
+    struct unit
+    {
+        constexpr bool operator==(const unit&) const noexcept = default;
+    };
+
+    /**
+     * @brief Boolean constant to check if a type is `unit`.
+     */
+    template<typename T>
+    static constexpr bool is_unit_v = is_same_v<remove_cvrf_t<T>, unit>;
+
+    /**
+     * @brief Trait to check if a type is a `tuple`.
+     */
+    template<typename T>
+    struct is_tuple : false_type {};
+
+    /**
+     * @brief Specialization for `tuple` types.
+     */
+    template<typename... elements>
+    struct is_tuple<tuple<elements...>> : true_type {};
+
+    /**
+     * @brief Boolean constant to check if a type is a `tuple`.
+     */
+    template<typename T>
+    static constexpr bool is_tuple_v = is_tuple<T>::value;
+
+    /**
+     * @brief The value type produced by a parser.
+     *
+     * @tparam P The parser type.
+     */
+    template<typename P>
+    using parser_result_t = typename remove_cvrf_t<P>::result_type;
+
+    namespace detail
+    {
+        /**
+         * @brief Matches a literal character sequence.
+         */
+        struct lit_parser
+        {
+            using result_type = unit;
+
+            std::string_view text; ///< The characters to match.
+
+            constexpr std::optional<unit> parse(std::string_view& in) const noexcept
+            {
+                if (!in.starts_with(text))
+                    return std::nullopt;
+                in.remove_prefix(text.size());
+                return unit{};
+            }
+        };
+
+        /**
+         * @brief Parses a decimal integer, rejecting values that do not fit in `T`.
+         *
+         * @tparam T The integral type to produce.
+         */
+        template<typename T>
+        struct int_parser
+        {
+            using result_type = T;
+
+            constexpr std::optional<T> parse(std::string_view& in) const noexcept
+            {
+                using U = std::make_unsigned_t<T>;
+
+                size_t i = 0;
+                bool negative = false;
+                if constexpr (std::is_signed_v<T>)
+                {
+                    if (i < in.size() && in[i] == '-')
+                    {
+                        negative = true;
+                        ++i;
+                    }
+                }
+
+                const size_t first_digit = i;
+                const U limit = negative ? U(U(std::numeric_limits<T>::max()) + 1) : U(std::numeric_limits<T>::max());
+                U value = 0;
+                for (; i < in.size() && in[i] >= '0' && in[i] <= '9'; ++i)
+                {
+                    const U digit = U(in[i] - '0');
+                    if (value > U((limit - digit) / 10))
+                        return std::nullopt;
+                    value = U(value * 10 + digit);
+                }
+                if (i == first_digit)
+                    return std::nullopt;
+
+                in.remove_prefix(i);
+                return negative ? T(U(0) - value) : T(value);
+            }
+        };
+
+        /**
+         * @brief Parses a fixed-width little-endian integer from binary input.
+         *
+         * @tparam T The integral type to produce.
+         */
+        template<typename T>
+        struct le_parser
+        {
+            using result_type = T;
+
+            constexpr std::optional<T> parse(std::string_view& in) const noexcept
+            {
+                using U = std::make_unsigned_t<T>;
+
+                if (in.size() < sizeof(T))
+                    return std::nullopt;
+
+                U value = 0;
+                for (size_t i = 0; i < sizeof(T); ++i)
+                    value = U(value | U(U(static_cast<unsigned char>(in[i])) << (8 * i)));
+
+                in.remove_prefix(sizeof(T));
+                return T(value);
+            }
+        };
+
+        /**
+         * @brief Runs a parser and discards its value.
+         */
+        template<typename P>
+        struct skip_parser
+        {
+            using result_type = unit;
+
+            P p; ///< The parser whose value is discarded.
+
+            constexpr std::optional<unit> parse(std::string_view& in) const
+            {
+                if (!p.parse(in))
+                    return std::nullopt;
+                return unit{};
+            }
+        };
+
+        /**
+         * @brief Converts a parser value into the tuple it contributes to a sequence.
+         *
+         * `unit` contributes nothing, a tuple (from a nested `seq`) is spliced in as is and
+         * any other value becomes a one-element tuple.
+         */
+        template<typename T>
+        constexpr auto as_seq_part(T&& value)
+        {
+            if constexpr (is_unit_v<T>)
+                return tuple<>{};
+            else if constexpr (is_tuple_v<remove_cvrf_t<T>>)
+                return remove_cvrf_t<T>(metakit::forward<T>(value));
+            else
+                return tuple<remove_cvrf_t<T>>{ metakit::forward<T>(value) };
+        }
+
+        /**
+         * @brief Runs parsers one after another, concatenating their non-`unit` values.
+         *
+         * Intermediate values live in a tuple of optionals on the stack, so a sequence of
+         * fixed-shape parsers never allocates.
+         */
+        template<typename... Ps>
+        struct seq_parser
+        {
+            using result_type = decltype(tuple_cat(as_seq_part(std::declval<parser_result_t<Ps>>())...));
+
+            tuple<Ps...> ps; ///< The parsers, in order.
+
+            constexpr std::optional<result_type> parse(std::string_view& in) const
+            {
+                return parse_impl(in, make_index_sequence<sizeof...(Ps)>{});
+            }
+
+        private:
+            template<size_t... indices>
+            constexpr std::optional<result_type> parse_impl(std::string_view& in, index_sequence<indices...>) const
+            {
+                const std::string_view start = in;
+                tuple<std::optional<parser_result_t<Ps>>...> values{ std::optional<parser_result_t<Ps>>{}... };
+
+                const bool matched = ((get<indices>(values) = get<indices>(ps).parse(in)).has_value() && ...);
+                if (!matched)
+                {
+                    in = start;
+                    return std::nullopt;
+                }
+                return tuple_cat(as_seq_part(*get<indices>(metakit::move(values)))...);
+            }
+        };
+
+        /**
+         * @brief The value type of an alternative: the common result or a variant indexed by alternative.
+         */
+        template<typename R, typename... Rs>
+        struct alt_result : if_<(is_same_v<R, Rs> && ...), R, std::variant<R, Rs...>> {};
+
+        /**
+         * @brief Tries parsers in order and yields the value of the first that matches.
+         */
+        template<typename... Ps>
+        struct alt_parser
+        {
+            using result_type = typename alt_result<parser_result_t<Ps>...>::type;
+
+            tuple<Ps...> ps; ///< The alternatives, in order of preference.
+
+            constexpr std::optional<result_type> parse(std::string_view& in) const
+            {
+                std::optional<result_type> result;
+                try_alternative<0>(in, result);
+                return result;
+            }
+
+        private:
+            template<size_t i>
+            constexpr void try_alternative(std::string_view& in, std::optional<result_type>& result) const
+            {
+                if constexpr (i < sizeof...(Ps))
+                {
+                    const std::string_view start = in;
+                    if (auto value = get<i>(ps).parse(in))
+                    {
+                        if constexpr (is_same_v<result_type, parser_result_t<tuple_element_t<i, tuple<Ps...>>>>)
+                            result.emplace(metakit::move(*value));
+                        else
+                            result.emplace(std::in_place_index<i>, metakit::move(*value));
+                        return;
+                    }
+                    in = start;
+                    try_alternative<i + 1>(in, result);
+                }
+            }
+        };
+
+        /**
+         * @brief Repeats a parser for as long as it matches and makes progress.
+         *
+         * A `unit` parser repeats without storage, any other parser collects its values
+         * into a `std::vector`.
+         */
+        template<typename P>
+        struct many_parser
+        {
+            using result_type = typename if_<is_unit_v<parser_result_t<P>>, unit, std::vector<parser_result_t<P>>>::type;
+
+            P p; ///< The repeated parser.
+
+            constexpr std::optional<result_type> parse(std::string_view& in) const
+            {
+                result_type result{};
+                while (true)
+                {
+                    const std::string_view start = in;
+                    auto value = p.parse(in);
+                    if (!value || in.size() == start.size())
+                    {
+                        in = start;
+                        return result;
+                    }
+                    if constexpr (!is_unit_v<parser_result_t<P>>)
+                        result.push_back(metakit::move(*value));
+                }
+            }
+        };
+
+        /**
+         * @brief Repeats a parser, handing each value to a sink instead of storing it.
+         */
+        template<typename P, typename Sink>
+        struct many_into_parser
+        {
+            using result_type = unit;
+
+            P p;       ///< The repeated parser.
+            Sink sink; ///< Called with every parsed value.
+
+            constexpr std::optional<unit> parse(std::string_view& in) const
+            {
+                while (true)
+                {
+                    const std::string_view start = in;
+                    auto value = p.parse(in);
+                    if (!value || in.size() == start.size())
+                    {
+                        in = start;
+                        return unit{};
+                    }
+                    sink(metakit::move(*value));
+                }
+            }
+        };
+    }//end of namespace detail
+
+    /**
+     * @brief Creates a parser matching a literal character sequence.
+     *
+     * @param text The characters to match; must outlive the parser.
+     */
+    constexpr detail::lit_parser lit(std::string_view text) noexcept
+    {
+        return { text };
+    }
+
+    /**
+     * @brief Parser for a decimal integer of type `T`.
+     */
+    template<typename T = int>
+    requires(is_integral_v<T>)
+    inline constexpr detail::int_parser<T> int_{};
+
+    /**
+     * @brief Parser for a little-endian binary integer of type `T`.
+     */
+    template<typename T>
+    requires(is_integral_v<T>)
+    inline constexpr detail::le_parser<T> le_{};
+
+    /**
+     * @brief Creates a parser that matches `p` and discards its value.
+     */
+    template<typename P>
+    constexpr auto skip(P p)
+    {
+        return detail::skip_parser<P>{ metakit::move(p) };
+    }
+
+    /**
+     * @brief Creates a parser matching all parsers in order.
+     *
+     * The values are concatenated into a `tuple`; `unit` values are dropped and the
+     * values of nested sequences are spliced in.
+     */
+    template<typename... Ps>
+    requires(sizeof...(Ps) > 0)
+    constexpr auto seq(Ps... ps)
+    {
+        return detail::seq_parser<Ps...>{ tuple<Ps...>{ metakit::move(ps)... } };
+    }
+
+    /**
+     * @brief Creates a parser matching the first of several alternatives.
+     *
+     * When the alternatives produce different types the value is a `std::variant`
+     * whose active index is the index of the matching alternative.
+     */
+    template<typename... Ps>
+    requires(sizeof...(Ps) > 0)
+    constexpr auto alt(Ps... ps)
+    {
+        return detail::alt_parser<Ps...>{ tuple<Ps...>{ metakit::move(ps)... } };
+    }
+
+    /**
+     * @brief Creates a parser matching `p` zero or more times.
+     */
+    template<typename P>
+    constexpr auto many(P p)
+    {
+        return detail::many_parser<P>{ metakit::move(p) };
+    }
+
+    /**
+     * @brief Creates a parser matching `p` zero or more times, passing every value to `sink`.
+     */
+    template<typename P, typename Sink>
+    constexpr auto many(P p, Sink sink)
+    {
+        return detail::many_into_parser<P, Sink>{ metakit::move(p), metakit::move(sink) };
+    }
+
+    /**
+     * @brief Parses the whole of `text` with `p`.
+     *
+     * @return The value of `p`, or `std::nullopt` if it fails or leaves input unconsumed.
+     */
+    template<typename P>
+    constexpr std::optional<parser_result_t<P>> parse(const P& p, std::string_view text)
+    {
+        auto result = p.parse(text);
+        if (!text.empty())
+            return std::nullopt;
+        return result;
+    }
+
+    /**
+     * @brief Parses the whole of a binary buffer with `p`.
+     */
+    template<typename P>
+    std::optional<parser_result_t<P>> parse(const P& p, std::span<const std::byte> bytes)
+    {
+        return parse(p, std::string_view{ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+    }
+}
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef PATCH_H
+#define PATCH_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "tuple.h"
+
+/**
+ * @brief Field-level diff and patch of tuples, for replicating records incrementally.
+ *
+ * `diff` compares two tuples element-wise into a bitmask of changed fields; `serialize_patch`
+ * writes that mask followed by only the changed fields, and `apply_patch` applies it to a
+ * replica. The layout is fixed at compile time from the element types, which must therefore
+ * be trivially copyable; fields are written in their native byte order, so sender and
+ * receiver must agree on it. `serialize` writes the full record in the same layout.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief One bit per field of a tuple, set for the fields that changed.
+     *
+     * @tparam N The number of fields.
+     */
+    template<size_t N>
+    struct field_mask
+    {
+        static constexpr size_t word_count = (N + 63) / 64; ///< The number of 64-bit words.
+        static constexpr size_t byte_count = (N + 7) / 8;   ///< The size of the mask in a patch.
+
+        std::array<std::uint64_t, word_count> words{}; ///< Field `i` is bit `i % 64` of word `i / 64`.
+
+        constexpr bool test(size_t i) const noexcept { return (words[i / 64] >> (i % 64)) & 1; }
+        constexpr void set(size_t i) noexcept { words[i / 64] |= std::uint64_t(1) << (i % 64); }
+
+        /**
+         * @brief Retrieves the number of changed fields.
+         */
+        constexpr size_t count() const noexcept
+        {
+            size_t n = 0;
+            for (const auto w : words)
+                n += size_t(std::popcount(w));
+            return n;
+        }
+
+        constexpr bool any() const noexcept { return count() != 0; }
+
+        constexpr bool operator==(const field_mask&) const noexcept = default;
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Unsigned integer of a given size, for comparing arithmetic fields by their bits.
+         */
+        template<size_t size> struct bits_of_size : has_type<void> {};
+        template<> struct bits_of_size<1> : has_type<std::uint8_t> {};
+        template<> struct bits_of_size<2> : has_type<std::uint16_t> {};
+        template<> struct bits_of_size<4> : has_type<std::uint32_t> {};
+        template<> struct bits_of_size<8> : has_type<std::uint64_t> {};
+
+        /**
+         * @brief Computes a value that is zero exactly when a field is equal in two records.
+         *
+         * Arithmetic fields are compared by their bits, which is what replication needs (a NaN
+         * that stays NaN is unchanged, 0.0 becoming -0.0 is a change): the result is the XOR of
+         * their representations, a load and an XOR with no floating point compare or branch.
+         * Other fields fall back to `operator==`.
+         */
+        template<typename T>
+        METAKIT_ALWAYS_INLINE constexpr std::uint64_t field_delta(const T& a, const T& b) noexcept
+        {
+            using bits = typename bits_of_size<sizeof(T)>::type;
+            if constexpr (std::is_arithmetic_v<T> && !is_same_v<bits, void>)
+                return std::uint64_t(std::bit_cast<bits>(a) ^ std::bit_cast<bits>(b));
+            else
+                return std::uint64_t(!(a == b));
+        }
+
+        /**
+         * @brief Sets bit `i` of the result for every non-zero `deltas[i]`, 64 deltas at most.
+         *
+         * Reduces two deltas per SSE2 instruction sequence on x86, where 64-bit lanes are
+         * compared to zero as pairs of 32-bit lanes and their signs gathered with `movmskpd`.
+         */
+        inline std::uint64_t nonzero_mask(const std::uint64_t* deltas, size_t n) noexcept
+        {
+            std::uint64_t mask = 0;
+            size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 2 <= n; i += 2)
+            {
+                const __m128i equal32 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i)), zero);
+                const __m128i equal64 = _mm_and_si128(equal32, _mm_shuffle_epi32(equal32, _MM_SHUFFLE(2, 3, 0, 1)));
+                mask |= std::uint64_t(~_mm_movemask_pd(_mm_castsi128_pd(equal64)) & 3) << i;
+            }
+#endif
+            for (; i < n; ++i)
+                mask |= std::uint64_t(deltas[i] != 0) << i;
+            return mask;
+        }
+
+        template<typename Tuple>
+        static constexpr size_t field_count_v = tuple_size_v<remove_cvrf_t<Tuple>>;
+
+        template<typename Tuple, size_t... indices>
+        constexpr field_mask<sizeof...(indices)> diff_impl(const Tuple& a, const Tuple& b, index_sequence<indices...>) noexcept
+        {
+            constexpr size_t n = sizeof...(indices);
+            field_mask<n> mask;
+            if (std::is_constant_evaluated())
+            {
+                ((mask.words[indices / 64] |= std::uint64_t(field_delta(get<indices>(a), get<indices>(b)) != 0) << (indices % 64)), ...);
+                return mask;
+            }
+
+            const std::uint64_t deltas[n] = { field_delta(get<indices>(a), get<indices>(b))... };
+            for (size_t w = 0; w < field_mask<n>::word_count; ++w)
+                mask.words[w] = nonzero_mask(deltas + w * 64, n - w * 64 < 64 ? n - w * 64 : 64);
+            return mask;
+        }
+
+        template<typename Tuple, size_t... indices>
+        constexpr size_t record_size_impl(index_sequence<indices...>) noexcept
+        {
+            return (size_t(0) + ... + sizeof(tuple_element_t<indices, Tuple>));
+        }
+
+        template<typename Tuple, size_t... indices>
+        constexpr bool all_trivially_copyable(index_sequence<indices...>) noexcept
+        {
+            return (true && ... && is_trivially_copyable_v<tuple_element_t<indices, Tuple>>);
+        }
+    }//end of namespace detail
+
+    /**
+     * @brief The size of a full record of `Tuple` in the serialized layout.
+     */
+    template<typename Tuple>
+    static constexpr size_t record_size_v = detail::record_size_impl<Tuple>(make_index_sequence<detail::field_count_v<Tuple>>{});
+
+    /**
+     * @brief The largest patch of `Tuple`: the mask followed by every field.
+     */
+    template<typename Tuple>
+    static constexpr size_t max_patch_size_v = field_mask<detail::field_count_v<Tuple>>::byte_count + record_size_v<Tuple>;
+
+    /**
+     * @brief Computes which fields differ between two tuples of the same type.
+     */
+    template<typename Tuple>
+    constexpr auto diff(const Tuple& a, const Tuple& b) noexcept
+    {
+        return detail::diff_impl(a, b, make_index_sequence<detail::field_count_v<Tuple>>{});
+    }
+
+    /**
+     * @brief Writes every field of a tuple, in order and without padding.
+     *
+     * @return The number of bytes written, `record_size_v<Tuple>`, or 0 if `out` is too small.
+     */
+    template<typename Tuple>
+    size_t serialize(const Tuple& record, std::span<std::byte> out) noexcept
+    {
+        constexpr size_t n = detail::field_count_v<Tuple>;
+        static_assert(detail::all_trivially_copyable<Tuple>(make_index_sequence<n>{}), "serialized fields must be trivially copyable");
+        if (out.size() < record_size_v<Tuple>)
+            return 0;
+
+        size_t position = 0;
+        [&]<size_t... indices>(index_sequence<indices...>)
+        {
+            ((std::memcpy(out.data() + position, &get<indices>(record), sizeof(tuple_element_t<indices, Tuple>)),
+              position += sizeof(tuple_element_t<indices, Tuple>)), ...);
+        }(make_index_sequence<n>{});
+        return position;
+    }
+
+    /**
+     * @brief Writes the mask of changed fields followed by the changed fields of `current`.
+     *
+     * Every field is copied and the write position advances only past the changed ones, so
+     * the loop has no branch per field; `out` must therefore hold `max_patch_size_v<Tuple>`
+     * bytes even when the patch will be smaller.
+     *
+     * @return The size of the patch, or 0 if `out` is smaller than `max_patch_size_v<Tuple>`.
+     */
+    template<typename Tuple>
+    size_t serialize_patch(const Tuple& current, const field_mask<detail::field_count_v<Tuple>>& changed,
+        std::span<std::byte> out) noexcept
+    {
+        constexpr size_t n = detail::field_count_v<Tuple>;
+        static_assert(detail::all_trivially_copyable<Tuple>(make_index_sequence<n>{}), "patched fields must be trivially copyable");
+        if (out.size() < max_patch_size_v<Tuple>)
+            return 0;
+
+        std::memcpy(out.data(), changed.words.data(), field_mask<n>::byte_count);
+        size_t position = field_mask<n>::byte_count;
+        [&]<size_t... indices>(index_sequence<indices...>)
+        {
+            ((std::memcpy(out.data() + position, &get<indices>(current), sizeof(tuple_element_t<indices, Tuple>)),
+              position += changed.test(indices) ? sizeof(tuple_element_t<indices, Tuple>) : 0), ...);
+        }(make_index_sequence<n>{});
+        return position;
+    }
+
+    /**
+     * @brief Writes the patch that turns `previous` into `current`.
+     */
+    template<typename Tuple>
+    size_t serialize_patch(const Tuple& previous, const Tuple& current, std::span<std::byte> out) noexcept
+    {
+        return serialize_patch(current, diff(previous, current), out);
+    }
+
+    /**
+     * @brief Overwrites the fields of `target` that a patch carries.
+     *
+     * @return The number of bytes the patch took, or `std::nullopt` if it is truncated or sets
+     * bits beyond the last field; `target` is unchanged in that case.
+     */
+    template<typename Tuple>
+    std::optional<size_t> apply_patch(Tuple& target, std::span<const std::byte> patch) noexcept
+    {
+        constexpr size_t n = detail::field_count_v<Tuple>;
+        static_assert(detail::all_trivially_copyable<Tuple>(make_index_sequence<n>{}), "patched fields must be trivially copyable");
+        if (patch.size() < field_mask<n>::byte_count)
+            return std::nullopt;
+
+        field_mask<n> changed;
+        std::memcpy(changed.words.data(), patch.data(), field_mask<n>::byte_count);
+        if constexpr (n % 64 != 0)
+            if (changed.words.back() >> (n % 64) != 0)
+                return std::nullopt;
+
+        const size_t size = [&]<size_t... indices>(index_sequence<indices...>)
+        {
+            return (field_mask<n>::byte_count + ... + (changed.test(indices) ? sizeof(tuple_element_t<indices, Tuple>) : 0));
+        }(make_index_sequence<n>{});
+        if (patch.size() < size)
+            return std::nullopt;
+
+        size_t position = field_mask<n>::byte_count;
+        [&]<size_t... indices>(index_sequence<indices...>)
+        {
+            ((changed.test(indices) ? (std::memcpy(&get<indices>(target), patch.data() + position, sizeof(tuple_element_t<indices, Tuple>)),
+              position += sizeof(tuple_element_t<indices, Tuple>)) : position), ...);
+        }(make_index_sequence<n>{});
+        return size;
+    }
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef PER_THREAD_H
+#define PER_THREAD_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "helper_.h"
+
+namespace metakit
+{
+    /**
+     * @brief One default-constructed `T` per thread that uses the set, visited on demand without locks.
+     *
+     * `local` finds the calling thread's object through a one-entry thread-local cache, so a
+     * thread that uses the same set repeatedly pays one comparison; on a miss, it searches the
+     * set's list for the object of the thread. Objects are published on a lock-free list and
+     * belong to the set, so the state of exited threads is kept, and a thread keeps nothing
+     * per set: long-lived threads may use any number of short-lived sets. The set must outlive
+     * its use.
+     *
+     * Each object is written by its thread only; `for_each` may read them while they are written,
+     * which is safe for objects whose members are written and read with atomic operations.
+     */
+    template <typename T>
+    class per_thread
+    {
+    public:
+        per_thread() = default;
+        per_thread(const per_thread&) = delete;
+        per_thread& operator=(const per_thread&) = delete;
+
+        ~per_thread()
+        {
+            for (node* n = head.load(std::memory_order_acquire); n != nullptr;)
+                delete std::exchange(n, n->next);
+        }
+
+        /**
+         * @brief Retrieves the calling thread's object, creating it on first use.
+         */
+        T& local()
+        {
+            if (cache.set_id == id) [[likely]]
+                return *static_cast<T*>(cache.object);
+            return attach();
+        }
+
+        /**
+         * @brief Calls `f(const T&)` for the object of every thread that used the set.
+         */
+        template <typename F>
+        void for_each(F&& f) const
+        {
+            for (const node* n = head.load(std::memory_order_acquire); n != nullptr; n = n->next)
+                f(n->value);
+        }
+
+    private:
+        struct alignas(64) node
+        {
+            T value{};
+            std::uint64_t owner = 0; ///< The `thread_id` of the thread that created it.
+            node* next = nullptr;
+        };
+
+        /**
+         * @brief The set and object the calling thread used last.
+         */
+        struct thread_cache
+        {
+            std::uint64_t set_id = 0;
+            void* object = nullptr;
+        };
+
+        /**
+         * @brief Finds the calling thread's node in the list, or publishes a new one.
+         *
+         * Only the calling thread adds nodes that it owns, so none can appear during the search.
+         */
+        METAKIT_NOINLINE T& attach()
+        {
+            const std::uint64_t self = thread_id;
+            node* found = head.load(std::memory_order_acquire);
+            while (found != nullptr && found->owner != self)
+                found = found->next;
+            if (found == nullptr)
+            {
+                auto fresh = std::make_unique<node>();
+                fresh->owner = self;
+                fresh->next = head.load(std::memory_order_relaxed);
+                while (!head.compare_exchange_weak(fresh->next, fresh.get(), std::memory_order_release, std::memory_order_relaxed)) {}
+                found = fresh.release();
+            }
+            cache = { id, &found->value };
+            return found->value;
+        }
+
+        static inline std::atomic<std::uint64_t> next_id{ 1 };
+        static inline thread_local thread_cache cache;
+        static inline thread_local const std::uint64_t thread_id = next_id.fetch_add(1, std::memory_order_relaxed); ///< Never reused, unlike `std::thread::id`.
+
+        const std::uint64_t id = next_id.fetch_add(1, std::memory_order_relaxed); ///< Never reused, unlike addresses.
+        std::atomic<node*> head{ nullptr };
+    };
+}
+
+#endif
@@ -0,0 +1,490 @@
+#ifndef RECORD_WRITER_H
+#define RECORD_WRITER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "tuple.h"
+
+/**
+ * @brief Appends tuple records to a file from a background thread, so that producers only copy bytes.
+ *
+ * The file has the layout that `external_sort` reads: trivially copyable records back to back,
+ * in their in-memory representation. Producers copy records into the active one of a few
+ * staging buffers, under a lock held for a `memcpy`; when it is full, it is queued for the
+ * flusher thread and a free buffer takes its place. The flusher writes every queued buffer in
+ * one positioned gather write (`pwritev`), then returns them to the free list. Producers only
+ * wait when all the buffers are queued, that is, when they outrun the disk.
+ *
+ * With `direct`, the file is opened with `O_DIRECT` where the file system supports it: writes
+ * bypass the page cache, so buffers are aligned, and every write but the last covers whole
+ * blocks, the remainder moving to the next buffer.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief When an `async_record_writer` waits for its data to reach the disk, with `fdatasync`.
+     */
+    enum class sync_policy
+    {
+        none,       ///< Never; the operating system writes the data back when it sees fit.
+        on_close,   ///< Once, when the writer closes.
+        every_batch ///< After every write, so that `flush` returns once the records are durable.
+    };
+
+    /**
+     * @brief Tuning of `async_record_writer`.
+     */
+    struct record_writer_options
+    {
+        size_t buffer_bytes = size_t(4) << 20;    ///< The size of each staging buffer, at least 64 KiB.
+        size_t buffers = 4;                       ///< The number of staging buffers, from 2 to 64.
+        bool direct = false;                      ///< Whether to bypass the page cache with `O_DIRECT`.
+        sync_policy sync = sync_policy::on_close; ///< When to wait for the disk.
+    };
+
+    /**
+     * @brief What an `async_record_writer` did.
+     */
+    struct record_writer_stats
+    {
+        std::uint64_t records = 0;        ///< The records pushed.
+        std::uint64_t bytes_written = 0;  ///< The bytes written to the file.
+        std::uint64_t writes = 0;         ///< The write calls of the flusher, each of one or more buffers.
+        std::uint64_t syncs = 0;          ///< The `fdatasync` calls.
+        std::uint64_t producer_waits = 0; ///< The times a producer waited for a free buffer.
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief A staging buffer: `used` bytes of records at `data`.
+         */
+        struct staging_buffer
+        {
+            std::byte* data = nullptr;
+            size_t used = 0;
+        };
+
+        /**
+         * @brief A file written with positioned writes of several buffers at once.
+         */
+        class log_file
+        {
+        public:
+            static constexpr size_t direct_alignment = 4096;
+
+            log_file() = default;
+            log_file(const log_file&) = delete;
+            log_file& operator=(const log_file&) = delete;
+            ~log_file() { close(); }
+
+            /**
+             * @brief Creates or truncates a file; `direct` is dropped if the file system does not support it.
+             */
+            bool open(const std::filesystem::path& path, bool direct) noexcept
+            {
+#if defined(_WIN32)
+                (void)direct;
+                fd_ = ::_wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+                constexpr int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#if defined(O_DIRECT)
+                if (direct)
+                {
+                    fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+                    direct_ = fd_ >= 0;
+                }
+#else
+                (void)direct;
+#endif
+                if (fd_ < 0)
+                    fd_ = ::open(path.c_str(), flags, 0644);
+#endif
+                return fd_ >= 0;
+            }
+
+            bool direct() const noexcept { return direct_; }
+
+            /**
+             * @brief Writes the used bytes of buffers one after the other, from `offset`.
+             */
+            bool write(const std::vector<staging_buffer*>& buffers, std::uint64_t offset) noexcept
+            {
+#if defined(_WIN32)
+                if (::_lseeki64(fd_, std::int64_t(offset), SEEK_SET) < 0)
+                    return false;
+                for (const staging_buffer* b : buffers)
+                    if (::_write(fd_, b->data, unsigned(b->used)) != int(b->used))
+                        return false;
+                return true;
+#else
+                std::vector<iovec> pieces;
+                for (const staging_buffer* b : buffers)
+                {
+                    pieces.push_back(iovec{ b->data, b->used });
+                    if (direct_ && b->used % direct_alignment != 0 && !drop_direct())
+                        return false;
+                }
+                for (iovec* next = pieces.data(), *end = pieces.data() + pieces.size(); next != end;)
+                {
+                    const ssize_t n = ::pwritev(fd_, next, int(end - next), off_t(offset));
+                    if (n < 0)
+                    {
+                        if (errno == EINTR)
+                            continue;
+                        return false;
+                    }
+                    // A short write: skip the pieces written and the written part of the next one.
+                    offset += std::uint64_t(n);
+                    size_t left = size_t(n);
+                    for (; next != end && left >= next->iov_len; ++next)
+                        left -= next->iov_len;
+                    if (next != end)
+                    {
+                        next->iov_base = static_cast<std::byte*>(next->iov_base) + left;
+                        next->iov_len -= left;
+                    }
+                }
+                return true;
+#endif
+            }
+
+            bool sync() noexcept
+            {
+#if defined(_WIN32)
+                return ::_commit(fd_) == 0;
+#elif defined(__linux__)
+                return ::fdatasync(fd_) == 0;
+#else
+                return ::fsync(fd_) == 0;
+#endif
+            }
+
+            bool close() noexcept
+            {
+                if (fd_ < 0)
+                    return true;
+#if defined(_WIN32)
+                const bool closed = ::_close(fd_) == 0;
+#else
+                const bool closed = ::close(fd_) == 0;
+#endif
+                fd_ = -1;
+                return closed;
+            }
+
+        private:
+            /**
+             * @brief Turns `O_DIRECT` off, for the last write of a file whose size is not a multiple of blocks.
+             */
+            bool drop_direct() noexcept
+            {
+#if defined(O_DIRECT)
+                const int flags = ::fcntl(fd_, F_GETFL);
+                if (flags < 0 || ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT) < 0)
+                    return false;
+#endif
+                direct_ = false;
+                return true;
+            }
+
+            int fd_ = -1;
+            bool direct_ = false;
+        };
+    }//end of namespace detail
+
+    /**
+     * @brief Appends records to a file through staging buffers flushed by a background thread.
+     *
+     * Any number of threads may push; the records of each thread are written in the order it
+     * pushed them. Write errors are reported by `flush` and `close`. The writer must not be used
+     * after `close`, or when `is_open` is false.
+     */
+    template<typename Tuple>
+    class async_record_writer
+    {
+        static_assert(is_trivially_copyable_v<Tuple>, "records are written as bytes and must be trivially copyable");
+
+    public:
+        /**
+         * @brief Creates or truncates a file and starts the flusher thread; check `is_open`.
+         */
+        explicit async_record_writer(const std::filesystem::path& path, record_writer_options options = {})
+            : options_(adjusted(options)),
+            storage_(static_cast<std::byte*>(::operator new(options_.buffers * options_.buffer_bytes, std::align_val_t(alignment))))
+        {
+            if (!file_.open(path, options_.direct))
+            {
+                ok_ = false;
+                return;
+            }
+            buffers_.resize(options_.buffers);
+            for (size_t i = 0; i < buffers_.size(); ++i)
+            {
+                buffers_[i].data = storage_.get() + i * options_.buffer_bytes;
+                free_.push_back(&buffers_[i]);
+            }
+            active_ = free_.back();
+            free_.pop_back();
+            pending_.reserve(buffers_.size());
+            flusher_ = std::thread([this] { run(); });
+        }
+
+        async_record_writer(const async_record_writer&) = delete;
+        async_record_writer& operator=(const async_record_writer&) = delete;
+
+        ~async_record_writer() { close(); }
+
+        bool is_open() const noexcept { return flusher_.joinable(); }
+
+        /**
+         * @brief Whether the file bypasses the page cache: `direct` was asked for and the file system supports it.
+         */
+        bool direct() const noexcept { return file_.direct(); }
+
+        void push(const Tuple& record)
+        {
+            std::unique_lock lock(mutex_);
+            if (options_.buffer_bytes - active_->used < sizeof(Tuple)) [[unlikely]]
+                make_room(lock);
+            append(&record, 1);
+        }
+
+        /**
+         * @brief Pushes consecutive records, taking the lock once per buffer they fill.
+         */
+        void push_many(std::span<const Tuple> records)
+        {
+            std::unique_lock lock(mutex_);
+            while (!records.empty())
+            {
+                make_room(lock);
+                const size_t n = std::min(records.size(), (options_.buffer_bytes - active_->used) / sizeof(Tuple));
+                append(records.data(), n);
+                records = records.subspan(n);
+            }
+        }
+
+        /**
+         * @brief Waits until the records pushed so far are written, and synced under `sync_policy::every_batch`.
+         *
+         * With `O_DIRECT`, up to a block of the last records stays in the buffer until more follow or the writer closes.
+         *
+         * @return Whether every write succeeded.
+         */
+        bool flush()
+        {
+            std::unique_lock lock(mutex_);
+            if (whole_blocks(active_->used) != 0)
+            {
+                wait_for_free(lock);
+                if (whole_blocks(active_->used) != 0)
+                    submit_active();
+            }
+            const std::uint64_t target = submitted_;
+            progress_.wait(lock, [&] { return completed_ >= target; });
+            return ok_;
+        }
+
+        /**
+         * @brief Writes the remaining records, stops the flusher, syncs under `sync_policy::on_close` and closes the file.
+         *
+         * @return Whether every write, sync and the close succeeded.
+         */
+        bool close()
+        {
+            if (!flusher_.joinable())
+                return ok_;
+            {
+                std::lock_guard lock(mutex_);
+                if (active_->used != 0)
+                {
+                    // The tail goes whole, whatever its alignment, and the writer takes no more records.
+                    pending_.push_back(active_);
+                    ++submitted_;
+                }
+                active_ = nullptr;
+                closing_ = true;
+            }
+            work_.notify_one();
+            flusher_.join();
+            if (ok_ && options_.sync == sync_policy::on_close)
+            {
+                ok_ = file_.sync();
+                ++syncs_;
+            }
+            ok_ &= file_.close();
+            return ok_;
+        }
+
+        record_writer_stats stats() const
+        {
+            std::lock_guard lock(mutex_);
+            return { records_, bytes_written_, writes_, syncs_, producer_waits_ };
+        }
+
+    private:
+        static constexpr size_t alignment = detail::log_file::direct_alignment;
+
+        static record_writer_options adjusted(record_writer_options options) noexcept
+        {
+            options.buffers = std::clamp<size_t>(options.buffers, 2, 64);
+            options.buffer_bytes = std::max({ options.buffer_bytes, size_t(64) << 10, 2 * (alignment + sizeof(Tuple)) });
+            options.buffer_bytes = (options.buffer_bytes + alignment - 1) / alignment * alignment;
+            return options;
+        }
+
+        /**
+         * @brief The bytes of a buffer that may be written now: all of them, or whole blocks with `O_DIRECT`.
+         */
+        size_t whole_blocks(size_t used) const noexcept
+        {
+            return file_.direct() ? used / alignment * alignment : used;
+        }
+
+        void append(const Tuple* records, size_t n) noexcept
+        {
+            std::memcpy(active_->data + active_->used, records, n * sizeof(Tuple));
+            active_->used += n * sizeof(Tuple);
+            records_ += n;
+        }
+
+        void wait_for_free(std::unique_lock<std::mutex>& lock)
+        {
+            if (free_.empty())
+            {
+                ++producer_waits_;
+                progress_.wait(lock, [&] { return !free_.empty(); });
+            }
+        }
+
+        /**
+         * @brief Ensures the active buffer has room for a record, queueing it if it is full.
+         */
+        void make_room(std::unique_lock<std::mutex>& lock)
+        {
+            // Other producers may replace the active buffer while this one waits.
+            while (options_.buffer_bytes - active_->used < sizeof(Tuple))
+            {
+                wait_for_free(lock);
+                if (options_.buffer_bytes - active_->used < sizeof(Tuple))
+                    submit_active();
+            }
+        }
+
+        /**
+         * @brief Queues the active buffer for the flusher, and takes a free buffer in its place.
+         */
+        void submit_active() noexcept
+        {
+            detail::staging_buffer* full = active_;
+            active_ = free_.back();
+            free_.pop_back();
+            const size_t written = whole_blocks(full->used);
+            std::memcpy(active_->data, full->data + written, full->used - written);
+            active_->used = full->used - written;
+            full->used = written;
+            pending_.push_back(full);
+            ++submitted_;
+            work_.notify_one();
+        }
+
+        /**
+         * @brief The flusher thread: writes every queued buffer in one call, then frees them.
+         */
+        void run()
+        {
+            std::vector<detail::staging_buffer*> batch;
+            batch.reserve(buffers_.size());
+            std::unique_lock lock(mutex_);
+            for (;;)
+            {
+                work_.wait(lock, [&] { return !pending_.empty() || closing_; });
+                if (pending_.empty())
+                    return;
+                batch.swap(pending_);
+                bool ok = ok_;
+                lock.unlock();
+
+                std::uint64_t bytes = 0;
+                for (const detail::staging_buffer* b : batch)
+                    bytes += b->used;
+                ok = ok && file_.write(batch, offset_);
+                offset_ += bytes;
+                const bool synced = ok && options_.sync == sync_policy::every_batch;
+                if (synced)
+                    ok = file_.sync();
+
+                lock.lock();
+                ok_ &= ok;
+                bytes_written_ += bytes;
+                ++writes_;
+                syncs_ += synced;
+                for (detail::staging_buffer* b : batch)
+                {
+                    b->used = 0;
+                    free_.push_back(b);
+                }
+                completed_ += batch.size();
+                batch.clear();
+                progress_.notify_all();
+            }
+        }
+
+        struct release
+        {
+            void operator()(std::byte* p) const noexcept { ::operator delete(p, std::align_val_t(alignment)); }
+        };
+
+        const record_writer_options options_;
+        std::unique_ptr<std::byte, release> storage_;
+        detail::log_file file_;
+        std::vector<detail::staging_buffer> buffers_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable work_;     ///< Signals the flusher that buffers are queued, or that the writer closes.
+        std::condition_variable progress_; ///< Signals producers that buffers were written and freed.
+        detail::staging_buffer* active_ = nullptr;
+        std::vector<detail::staging_buffer*> free_;
+        std::vector<detail::staging_buffer*> pending_;
+        std::uint64_t submitted_ = 0; ///< The buffers queued so far.
+        std::uint64_t completed_ = 0; ///< The buffers written so far.
+        bool closing_ = false;
+        bool ok_ = true;
+
+        std::uint64_t offset_ = 0; ///< The end of the file, touched by the flusher only.
+        std::uint64_t records_ = 0;
+        std::uint64_t bytes_written_ = 0;
+        std::uint64_t writes_ = 0;
+        std::uint64_t syncs_ = 0;
+        std::uint64_t producer_waits_ = 0;
+
+        std::thread flusher_;
+    };
+}
+
+#endif
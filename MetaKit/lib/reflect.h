@@ -0,0 +1,142 @@
+#ifndef REFLECT_H
+#define REFLECT_H
+
+#include <type_traits>
+#include <utility>
+
+#include "tuple.h"
+#include "type_list.h"
+
+/**
+ * @brief Compile-time reflection of plain aggregates: their field count, types and references.
+ *
+ * The fields of an aggregate are counted by brace-initializing it from values convertible to
+ * anything, and reached through structured bindings. This covers structs with public fields,
+ * no base classes and no C array members (use `std::array` instead: brace elision would count
+ * each array element as a field), with up to `max_aggregate_fields` fields.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief The most fields an aggregate can have to be reflected.
+     */
+    inline constexpr size_t max_aggregate_fields = 16;
+
+    namespace detail
+    {
+        /**
+         * @brief Converts to any type but `Aggregate` itself, which would otherwise count as a copy.
+         */
+        template<typename Aggregate>
+        struct any_field
+        {
+            template<typename T>
+                requires (!is_same_v<remove_cvrf_t<T>, Aggregate>)
+            operator T() const noexcept;
+        };
+
+        template<typename T, size_t... indices>
+        constexpr bool brace_constructible_with(index_sequence<indices...>) noexcept
+        {
+            return requires { T{ (void(indices), any_field<T>{})... }; };
+        }
+
+        template<typename T, size_t n = 0>
+        constexpr size_t count_aggregate_fields() noexcept
+        {
+            if constexpr (n < max_aggregate_fields + 1 && brace_constructible_with<T>(make_index_sequence<n + 1>{}))
+                return count_aggregate_fields<T, n + 1>();
+            else
+                return n;
+        }
+
+        template<typename... Fields>
+        constexpr tuple<Fields&...> tie_fields(Fields&... fields) noexcept
+        {
+            return tuple<Fields&...>(fields...);
+        }
+    }//end of namespace detail
+
+    /**
+     * @brief The number of fields of an aggregate.
+     */
+    template<typename T>
+    inline constexpr size_t aggregate_field_count_v = detail::count_aggregate_fields<remove_cvrf_t<T>>();
+
+#define METAKIT_DETAIL_TIE_AGGREGATE(n, ...) \
+    else if constexpr (count == n) { auto& [__VA_ARGS__] = object; return detail::tie_fields(__VA_ARGS__); }
+
+    /**
+     * @brief Retrieves a tuple of references to the fields of an aggregate, in declaration order.
+     *
+     * The references are `const` when `object` is.
+     */
+    template<typename T>
+    constexpr auto aggregate_tie(T& object) noexcept
+    {
+        constexpr size_t count = aggregate_field_count_v<T>;
+        static_assert(std::is_aggregate_v<remove_cvrf_t<T>>, "only aggregates can be reflected");
+        static_assert(count <= max_aggregate_fields, "the aggregate has too many fields to be reflected");
+
+        if constexpr (count == 0) return tuple<>{};
+        METAKIT_DETAIL_TIE_AGGREGATE(1, f0)
+        METAKIT_DETAIL_TIE_AGGREGATE(2, f0, f1)
+        METAKIT_DETAIL_TIE_AGGREGATE(3, f0, f1, f2)
+        METAKIT_DETAIL_TIE_AGGREGATE(4, f0, f1, f2, f3)
+        METAKIT_DETAIL_TIE_AGGREGATE(5, f0, f1, f2, f3, f4)
+        METAKIT_DETAIL_TIE_AGGREGATE(6, f0, f1, f2, f3, f4, f5)
+        METAKIT_DETAIL_TIE_AGGREGATE(7, f0, f1, f2, f3, f4, f5, f6)
+        METAKIT_DETAIL_TIE_AGGREGATE(8, f0, f1, f2, f3, f4, f5, f6, f7)
+        METAKIT_DETAIL_TIE_AGGREGATE(9, f0, f1, f2, f3, f4, f5, f6, f7, f8)
+        METAKIT_DETAIL_TIE_AGGREGATE(10, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9)
+        METAKIT_DETAIL_TIE_AGGREGATE(11, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10)
+        METAKIT_DETAIL_TIE_AGGREGATE(12, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11)
+        METAKIT_DETAIL_TIE_AGGREGATE(13, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12)
+        METAKIT_DETAIL_TIE_AGGREGATE(14, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13)
+        METAKIT_DETAIL_TIE_AGGREGATE(15, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14)
+        METAKIT_DETAIL_TIE_AGGREGATE(16, f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15)
+    }
+
+#undef METAKIT_DETAIL_TIE_AGGREGATE
+
+    namespace detail
+    {
+        template<typename Tie>
+        struct tie_field_types;
+
+        template<typename... Fields>
+        struct tie_field_types<tuple<Fields&...>> : has_type<type_list<remove_cvrf_t<Fields>...>> {};
+    }//end of namespace detail
+
+    /**
+     * @brief The field types of an aggregate, in declaration order.
+     */
+    template<typename T>
+    using aggregate_fields_t = typename detail::tie_field_types<decltype(aggregate_tie(std::declval<remove_cvrf_t<T>&>()))>::type;
+
+    /**
+     * @brief Finds the position of a data member among the fields of its aggregate.
+     *
+     * Evaluated at compile time on a value-initialized aggregate, which must therefore be a literal type.
+     */
+    template<typename T, typename M>
+    consteval size_t aggregate_field_index(M T::* member)
+    {
+        T object{};
+        const auto fields = aggregate_tie(object);
+        size_t index = aggregate_field_count_v<T>;
+        [&]<size_t... indices>(index_sequence<indices...>)
+        {
+            ([&]
+            {
+                if constexpr (is_same_v<remove_cvrf_t<decltype(get<indices>(fields))>, remove_cvrf_t<M>>)
+                    if (&get<indices>(fields) == &(object.*member))
+                        index = indices;
+            }(), ...);
+        }(make_index_sequence<aggregate_field_count_v<T>>{});
+        return index;
+    }
+}
+
+#endif
@@ -0,0 +1,381 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "per_thread.h"
+#include "tuple_hash.h"
+
+/**
+ * @brief Mergeable streaming sketches: distinct counts, frequencies and quantiles in bounded memory.
+ *
+ * - `hyperloglog` estimates the number of distinct keys, with a relative standard error of
+ *   `1.04 / sqrt(2^Precision)`;
+ * - `count_min` estimates how often a key was added, overestimating by at most `e / Width` of
+ *   the total count with probability `1 - e^-Depth`;
+ * - `kll_sketch` estimates quantiles of a stream of ordered values, to within about
+ *   `1.7 / K` of the rank.
+ *
+ * Keys are tuples or named tuples, hashed once per update with `hash_value`; the `*_hash`
+ * members take that hash directly. The `add_many` members hash a block of keys before updating,
+ * so that the independent hash computations overlap and the counters they select are
+ * prefetched. `hyperloglog` and `count_min` write their counters with relaxed atomic operations,
+ * so `thread_sketches` can merge them while their threads keep adding.
+ */
+
+namespace metakit
+{
+    /**
+     * @brief Estimates the number of distinct keys added, in `2^Precision` bytes.
+     *
+     * @tparam Precision The number of hash bits selecting a register, 4 to 18.
+     */
+    template<unsigned Precision = 14>
+    class hyperloglog
+    {
+        static_assert(Precision >= 4 && Precision <= 18, "hyperloglog precision must be 4 to 18 bits");
+
+    public:
+        static constexpr size_t register_count = size_t(1) << Precision;
+        static constexpr bool merges_while_updating = true;
+
+        template<typename Key>
+        void add(const Key& key) noexcept { add_hash(hash_value(key)); }
+
+        /**
+         * @brief Adds a key given by its `hash_value`.
+         *
+         * The top `Precision` bits select a register, which keeps the longest run of leading zeros
+         * seen in the remaining bits.
+         */
+        METAKIT_ALWAYS_INLINE void add_hash(std::uint64_t hash) noexcept
+        {
+            const std::uint8_t rank = std::uint8_t(std::countl_zero((hash << Precision) | (std::uint64_t(1) << (Precision - 1))) + 1);
+            std::atomic_ref<std::uint8_t> reg(registers[hash >> (64 - Precision)]);
+            if (rank > reg.load(std::memory_order_relaxed))
+                reg.store(rank, std::memory_order_relaxed);
+        }
+
+        template<typename Key>
+        void add_many(std::span<const Key> keys) noexcept
+        {
+            detail::for_each_hash_batched(keys,
+                [&](std::uint64_t h) { detail::prefetch<true>(&registers[h >> (64 - Precision)]); },
+                [&](std::uint64_t h, size_t) { add_hash(h); });
+        }
+
+        /**
+         * @brief Adds the keys of another sketch of the same precision.
+         */
+        void merge(const hyperloglog& other) noexcept
+        {
+            for (size_t i = 0; i < register_count; ++i)
+            {
+                const std::uint8_t theirs = std::atomic_ref<const std::uint8_t>(other.registers[i]).load(std::memory_order_relaxed);
+                std::atomic_ref<std::uint8_t> reg(registers[i]);
+                if (theirs > reg.load(std::memory_order_relaxed))
+                    reg.store(theirs, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Estimates the number of distinct keys, with linear counting while many registers are empty.
+         */
+        double estimate() const noexcept
+        {
+            // Registers hold at most 64 - Precision + 1: count them by value, then sum 2^-value per value.
+            std::array<std::uint32_t, 66> by_rank{};
+            for (size_t i = 0; i < register_count; ++i)
+                ++by_rank[std::atomic_ref<const std::uint8_t>(registers[i]).load(std::memory_order_relaxed)];
+
+            double inverse_sum = 0;
+            for (size_t rank = 0; rank < by_rank.size(); ++rank)
+                inverse_sum += std::ldexp(double(by_rank[rank]), -int(rank));
+
+            constexpr double m = double(register_count);
+            const double alpha = register_count == 16 ? 0.673 : register_count == 32 ? 0.697 : register_count == 64 ? 0.709
+                : 0.7213 / (1 + 1.079 / m);
+            const double raw = alpha * m * m / inverse_sum;
+            if (raw <= 2.5 * m && by_rank[0] != 0)
+                return m * std::log(m / double(by_rank[0]));
+            return raw;
+        }
+
+        void clear() noexcept
+        {
+            for (auto& r : registers)
+                std::atomic_ref<std::uint8_t>(r).store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::uint8_t, register_count> registers{};
+    };
+
+    /**
+     * @brief Estimates how many times each key was added, in `Width * Depth` counters.
+     *
+     * Row `i` counts a key at column `(low + i * (high | 1)) mod Width`, with `low` and `high`
+     * the halves of its hash, so one hash serves every row; the odd step gives a key a
+     * different column in each of the first `Width` rows. Estimates never undercount.
+     *
+     * @tparam Width The counters per row, a power of two; the error is at most `e / Width` of the total.
+     * @tparam Depth The rows; the error bound fails with probability `e^-Depth`.
+     */
+    template<size_t Width = 2048, size_t Depth = 4>
+    class count_min
+    {
+        static_assert(std::has_single_bit(Width) && Depth >= 1, "count_min width must be a power of two");
+
+    public:
+        static constexpr bool merges_while_updating = true;
+
+        template<typename Key>
+        void add(const Key& key, std::uint64_t n = 1) noexcept { add_hash(hash_value(key), n); }
+
+        METAKIT_ALWAYS_INLINE void add_hash(std::uint64_t hash, std::uint64_t n = 1) noexcept
+        {
+            for (size_t row = 0; row < Depth; ++row)
+            {
+                std::atomic_ref<std::uint64_t> counter(counters[row][column(hash, row)]);
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+            std::atomic_ref<std::uint64_t>(total).store(std::atomic_ref<std::uint64_t>(total).load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+        }
+
+        template<typename Key>
+        void add_many(std::span<const Key> keys) noexcept
+        {
+            detail::for_each_hash_batched(keys,
+                [&](std::uint64_t h)
+                {
+                    for (size_t row = 0; row < Depth; ++row)
+                        detail::prefetch<true>(&counters[row][column(h, row)]);
+                },
+                [&](std::uint64_t h, size_t) { add_hash(h); });
+        }
+
+        template<typename Key>
+        std::uint64_t estimate(const Key& key) const noexcept { return estimate_hash(hash_value(key)); }
+
+        std::uint64_t estimate_hash(std::uint64_t hash) const noexcept
+        {
+            std::uint64_t smallest = ~std::uint64_t(0);
+            for (size_t row = 0; row < Depth; ++row)
+                smallest = std::min(smallest, std::atomic_ref<const std::uint64_t>(counters[row][column(hash, row)]).load(std::memory_order_relaxed));
+            return smallest;
+        }
+
+        /**
+         * @brief Retrieves the sum of every count added.
+         */
+        std::uint64_t total_count() const noexcept
+        {
+            return std::atomic_ref<const std::uint64_t>(total).load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Adds the counts of another sketch of the same dimensions.
+         */
+        void merge(const count_min& other) noexcept
+        {
+            for (size_t row = 0; row < Depth; ++row)
+                for (size_t c = 0; c < Width; ++c)
+                    counters[row][c] += std::atomic_ref<const std::uint64_t>(other.counters[row][c]).load(std::memory_order_relaxed);
+            total += other.total_count();
+        }
+
+    private:
+        static constexpr size_t column(std::uint64_t hash, size_t row) noexcept
+        {
+            return size_t((std::uint32_t(hash) + row * ((hash >> 32) | 1)) & (Width - 1));
+        }
+
+        std::array<std::array<std::uint64_t, Width>, Depth> counters{};
+        std::uint64_t total = 0;
+    };
+
+    /**
+     * @brief Estimates quantiles of a stream of values (KLL sketch).
+     *
+     * Values are kept in levels of compactors, a value at level `h` standing for `2^h` values.
+     * A full level is sorted and every other value, starting at a random one of the first two,
+     * moves up; capacities shrink by 2/3 per level below the top, so the sketch holds
+     * `O(K log(n / K))` values.
+     *
+     * Unlike the other sketches, a `kll_sketch` can only be merged while it is not updated.
+     *
+     * @tparam T The value type; tuples are compared with `Less`, e.g. `key_less`.
+     * @tparam K The capacity of the top level, which sets the accuracy.
+     */
+    template<typename T, size_t K = 200, typename Less = std::less<>>
+    class kll_sketch
+    {
+        static_assert(K >= 8, "kll_sketch needs a capacity of at least 8");
+
+    public:
+        static constexpr bool merges_while_updating = false;
+
+        kll_sketch() : levels(1), capacities(1, K) {}
+
+        void add(const T& value)
+        {
+            levels[0].push_back(value);
+            ++n;
+            if (levels[0].size() >= capacities[0])
+                compress();
+        }
+
+        void add_many(std::span<const T> values)
+        {
+            for (const T& v : values)
+                add(v);
+        }
+
+        /**
+         * @brief Adds the values of another sketch.
+         */
+        void merge(const kll_sketch& other)
+        {
+            if (levels.size() < other.levels.size())
+                add_levels(other.levels.size() - levels.size());
+            for (size_t h = 0; h < other.levels.size(); ++h)
+                levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+            n += other.n;
+            compress();
+        }
+
+        std::uint64_t count() const noexcept { return n; }
+
+        /**
+         * @brief Estimates the value below which a fraction `q` of the values fall; the sketch must not be empty.
+         */
+        T quantile(double q) const
+        {
+            const auto weighted = sorted_weighted();
+            const double target = q * double(n);
+            std::uint64_t seen = 0;
+            for (const auto& [value, weight] : weighted)
+            {
+                seen += weight;
+                if (double(seen) > target)
+                    return value;
+            }
+            return weighted.back().first;
+        }
+
+        /**
+         * @brief Estimates the fraction of the values that are less than or equal to `value`.
+         */
+        double rank(const T& value) const
+        {
+            std::uint64_t below = 0;
+            for (size_t h = 0; h < levels.size(); ++h)
+                for (const T& v : levels[h])
+                    below += Less{}(value, v) ? 0 : std::uint64_t(1) << h;
+            return n == 0 ? 0.0 : double(below) / double(n);
+        }
+
+        /**
+         * @brief Retrieves the number of values held, which bounds the sketch's memory.
+         */
+        size_t retained() const noexcept
+        {
+            size_t held = 0;
+            for (const auto& level : levels)
+                held += level.size();
+            return held;
+        }
+
+    private:
+        /**
+         * @brief Adds levels on top and recomputes the capacities, `K * (2/3)^depth` below the top level.
+         */
+        void add_levels(size_t count)
+        {
+            levels.resize(levels.size() + count);
+            capacities.resize(levels.size());
+            for (size_t h = 0; h < levels.size(); ++h)
+                capacities[h] = std::max<size_t>(2, size_t(double(K) * std::pow(2.0 / 3.0, double(levels.size() - h - 1))));
+        }
+
+        /**
+         * @brief Compacts every full level into the next one, adding a level when the top one is full.
+         */
+        void compress()
+        {
+            for (size_t h = 0; h < levels.size(); ++h)
+            {
+                if (levels[h].size() < capacities[h])
+                    continue;
+                if (h + 1 == levels.size())
+                    add_levels(1);
+
+                std::vector<T>& level = levels[h];
+                std::sort(level.begin(), level.end(), Less{});
+                const bool odd = level.size() % 2 != 0;
+                const size_t pairs_end = level.size() - (odd ? 1 : 0);
+                random = random * 6364136223846793005ull + 1442695040888963407ull;
+                for (size_t i = size_t(random >> 63); i < pairs_end; i += 2)
+                    levels[h + 1].push_back(level[i]);
+                level.erase(level.begin(), level.begin() + std::ptrdiff_t(pairs_end));
+            }
+        }
+
+        std::vector<std::pair<T, std::uint64_t>> sorted_weighted() const
+        {
+            std::vector<std::pair<T, std::uint64_t>> weighted;
+            weighted.reserve(retained());
+            for (size_t h = 0; h < levels.size(); ++h)
+                for (const T& v : levels[h])
+                    weighted.emplace_back(v, std::uint64_t(1) << h);
+            std::sort(weighted.begin(), weighted.end(), [](const auto& a, const auto& b) { return Less{}(a.first, b.first); });
+            return weighted;
+        }
+
+        std::vector<std::vector<T>> levels;
+        std::vector<size_t> capacities;
+        std::uint64_t n = 0;
+        std::uint64_t random = 0x853c49e6748fea9bull;
+    };
+
+    /**
+     * @brief One sketch per updating thread, merged on demand without locks.
+     *
+     * `merged` may run while threads update sketches whose `merges_while_updating` is true
+     * (`hyperloglog`, `count_min`); others must be merged once their threads are done.
+     */
+    template<typename Sketch>
+    class thread_sketches
+    {
+    public:
+        /**
+         * @brief Retrieves the calling thread's sketch, creating it on first use.
+         */
+        Sketch& local() { return threads.local(); }
+
+        /**
+         * @brief Merges the sketches of all threads.
+         */
+        Sketch merged() const
+        {
+            Sketch result;
+            threads.for_each([&](const Sketch& s) { result.merge(s); });
+            return result;
+        }
+
+    private:
+        per_thread<Sketch> threads;
+    };
+}
+
+#endif
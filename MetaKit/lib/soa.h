@@ -0,0 +1,242 @@
+#ifndef SOA_H
+#define SOA_H
+
+#include <span>
+#include <vector>
+
+#include "reflect.h"
+#include "tuple.h"
+#include "type_list.h"
+
+/**
+ * @brief Structure-of-arrays storage for plain aggregates.
+ *
+ * `soa_of<order>` keeps one `std::vector` per field of `order`, found with `aggregate_tie`, so
+ * that a scan over one field reads only that field's column. Fields are named either by their
+ * index or by a pointer to member:
+ *
+ *     soa_of<order> orders;
+ *     orders.push_back(order{ 1, 9.5, 3 });
+ *     for (const double price : orders.column<&order::price>()) ...
+ *     orders[0].get<&order::quantity>() += 1;
+ */
+
+namespace metakit
+{
+    namespace detail
+    {
+        template<typename T, typename Fields>
+        struct soa_storage;
+
+        template<typename T, typename... Fields>
+        struct soa_storage<T, type_list<Fields...>>
+        {
+            static_assert(sizeof...(Fields) != 0, "the aggregate has no fields to store");
+            static_assert(!(is_same_v<Fields, bool> || ...), "std::vector<bool> is not contiguous, store flags as std::uint8_t");
+
+            using columns_type = tuple<std::vector<Fields>...>;
+            using tie_type = tuple<Fields&...>;
+            using const_tie_type = tuple<const Fields&...>;
+        };
+
+        /**
+         * @brief Resolves a field key, either an index or a pointer to member of `T`, to an index.
+         */
+        template<typename T, auto key>
+        constexpr size_t soa_field_index() noexcept
+        {
+            if constexpr (std::is_member_object_pointer_v<decltype(key)>)
+            {
+                constexpr size_t index = aggregate_field_index(key);
+                static_assert(index < aggregate_field_count_v<T>, "the member is not a field of the aggregate");
+                return index;
+            }
+            else
+                return size_t(key);
+        }
+    }//end of namespace detail
+
+    /**
+     * @brief One column per field of the aggregate `T`.
+     */
+    template<typename T>
+    class soa_of
+    {
+        using storage = detail::soa_storage<T, aggregate_fields_t<T>>;
+        static constexpr size_t field_count = aggregate_field_count_v<T>;
+        using indices = make_index_sequence<field_count>;
+
+    public:
+        /**
+         * @brief A proxy for one element, accessing its fields in their columns.
+         *
+         * @tparam Soa `soa_of<T>` or `const soa_of<T>`.
+         */
+        template<typename Soa>
+        class basic_reference
+        {
+        public:
+            basic_reference(Soa& soa, size_t index) noexcept : soa_(&soa), index_(index) {}
+
+            /**
+             * @brief Accesses a field by index or by pointer to member.
+             */
+            template<auto key>
+            decltype(auto) get() const noexcept
+            {
+                return soa_->template column<key>()[index_];
+            }
+
+            /**
+             * @brief Retrieves a tuple of references to every field, in declaration order.
+             */
+            auto tie() const noexcept
+            {
+                return [&]<size_t... is>(index_sequence<is...>)
+                {
+                    using tie_type = typename if_<std::is_const_v<Soa>, typename storage::const_tie_type, typename storage::tie_type>::type;
+                    return tie_type(this->template get<is>()...);
+                }(indices{});
+            }
+
+            /**
+             * @brief Gathers the fields into an aggregate.
+             */
+            operator T() const
+            {
+                return soa_->load(index_);
+            }
+
+            /**
+             * @brief Scatters the fields of an aggregate into this element.
+             */
+            const basic_reference& operator=(const T& value) const
+                requires (!std::is_const_v<Soa>)
+            {
+                soa_->store(index_, value);
+                return *this;
+            }
+
+        private:
+            Soa* soa_;
+            size_t index_;
+        };
+
+        using reference = basic_reference<soa_of>;
+        using const_reference = basic_reference<const soa_of>;
+
+        soa_of()
+            : columns_([]<size_t... is>(index_sequence<is...>)
+                {
+                    return typename storage::columns_type(std::vector<at_t<aggregate_fields_t<T>, is>>()...);
+                }(indices{}))
+        {}
+
+        size_t size() const noexcept { return metakit::get<0>(columns_).size(); }
+        bool empty() const noexcept { return size() == 0; }
+
+        void reserve(size_t n)
+        {
+            for_each_column([n](auto& column) { column.reserve(n); });
+        }
+
+        void clear() noexcept
+        {
+            for_each_column([](auto& column) { column.clear(); });
+        }
+
+        /**
+         * @brief Appends an element, scattering its fields into the columns.
+         *
+         * Strongly exception-safe: every column is grown before any field is appended, and if
+         * copying a field throws, the fields already appended are removed, so the columns keep
+         * the same size.
+         */
+        void push_back(const T& value)
+        {
+            const size_t n = size();
+            for_each_column([n](auto& column)
+                {
+                    if (column.capacity() == n)
+                        column.reserve(n < 8 ? 8 : 2 * n);
+                });
+
+            const auto fields = aggregate_tie(value);
+            column_rollback rollback{ *this };
+            [&]<size_t... is>(index_sequence<is...>)
+            {
+                ((metakit::get<is>(columns_).push_back(metakit::get<is>(fields)), ++rollback.pushed), ...);
+            }(indices{});
+            rollback.pushed = 0;
+        }
+
+        /**
+         * @brief Retrieves the column of a field, given by index or by pointer to member.
+         */
+        template<auto key>
+        std::span<at_t<aggregate_fields_t<T>, detail::soa_field_index<T, key>()>> column() noexcept
+        {
+            return metakit::get<detail::soa_field_index<T, key>()>(columns_);
+        }
+
+        template<auto key>
+        std::span<const at_t<aggregate_fields_t<T>, detail::soa_field_index<T, key>()>> column() const noexcept
+        {
+            return metakit::get<detail::soa_field_index<T, key>()>(columns_);
+        }
+
+        reference operator[](size_t index) noexcept { return reference(*this, index); }
+        const_reference operator[](size_t index) const noexcept { return const_reference(*this, index); }
+
+        /**
+         * @brief Gathers the fields of an element into an aggregate.
+         */
+        T load(size_t index) const
+        {
+            return [&]<size_t... is>(index_sequence<is...>)
+            {
+                return T{ metakit::get<is>(columns_)[index]... };
+            }(indices{});
+        }
+
+        /**
+         * @brief Scatters the fields of an aggregate into an element.
+         */
+        void store(size_t index, const T& value)
+        {
+            const auto fields = aggregate_tie(value);
+            [&]<size_t... is>(index_sequence<is...>)
+            {
+                ((metakit::get<is>(columns_)[index] = metakit::get<is>(fields)), ...);
+            }(indices{});
+        }
+
+    private:
+        /**
+         * @brief Removes the last element of the first `pushed` columns on destruction.
+         */
+        struct column_rollback
+        {
+            soa_of& self;
+            size_t pushed = 0;
+
+            ~column_rollback()
+            {
+                [this]<size_t... is>(index_sequence<is...>)
+                {
+                    ((is < pushed ? metakit::get<is>(self.columns_).pop_back() : void()), ...);
+                }(indices{});
+            }
+        };
+
+        template<typename F>
+        void for_each_column(F&& f)
+        {
+            [&]<size_t... is>(index_sequence<is...>) { (f(metakit::get<is>(columns_)), ...); }(indices{});
+        }
+
+        typename storage::columns_type columns_;
+    };
+}
+
+#endif
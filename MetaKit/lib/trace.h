@@ -0,0 +1,540 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "type_list.h"
+
+namespace metakit
+{
+    namespace detail
+    {
+        /**
+         * @brief Reads the cheapest monotonic tick counter of the CPU.
+         *
+         * The time stamp counter on x86, the virtual counter on AArch64 and `steady_clock`
+         * elsewhere. Ticks are converted to nanoseconds offline, from the calibration that
+         * every trace file starts with.
+         */
+        METAKIT_ALWAYS_INLINE std::uint64_t trace_ticks() noexcept
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#elif defined(__aarch64__)
+            std::uint64_t ticks;
+            asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+            return ticks;
+#else
+            return std::uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        /**
+         * @brief Retrieves the `steady_clock` time in nanoseconds.
+         */
+        inline std::uint64_t trace_nanoseconds() noexcept
+        {
+            return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        /**
+         * @brief A tick count and the `steady_clock` nanoseconds read at the same moment.
+         */
+        struct trace_clock_pair
+        {
+            std::uint64_t ticks;
+            std::uint64_t ns;
+        };
+
+        /**
+         * @brief Reads both clocks, taking the tick count between two clock reads that lie closest together.
+         */
+        inline trace_clock_pair trace_clock_now() noexcept
+        {
+            trace_clock_pair best{ 0, 0 };
+            std::uint64_t best_gap = ~std::uint64_t(0);
+            for (int attempt = 0; attempt < 8; ++attempt)
+            {
+                const std::uint64_t before = trace_nanoseconds();
+                const std::uint64_t ticks = trace_ticks();
+                const std::uint64_t after = trace_nanoseconds();
+                if (after - before < best_gap)
+                {
+                    best_gap = after - before;
+                    best = { ticks, before + (after - before) / 2 };
+                }
+            }
+            return best;
+        }
+
+        /**
+         * @brief The clock pair taken when the first thread attached or the first header was written.
+         */
+        inline const trace_clock_pair& trace_clock_origin() noexcept
+        {
+            static const trace_clock_pair origin = trace_clock_now();
+            return origin;
+        }
+
+        /**
+         * @brief Follows the schema in a trace file: two clock pairs that the tick rate is fitted through.
+         */
+        struct trace_calibration
+        {
+            trace_clock_pair origin; ///< `trace_clock_origin()`.
+            trace_clock_pair sample; ///< A pair taken when the header is written, at least `trace_calibration_span` later.
+        };
+
+        inline constexpr std::chrono::milliseconds trace_calibration_span{ 10 };
+
+        /**
+         * @brief The fixed part of every record in a ring and in a trace file.
+         */
+        struct trace_record_header
+        {
+            std::uint64_t ticks;  ///< `trace_ticks()` when the event was emitted.
+            std::uint32_t tag;    ///< The position of the event type in the schema.
+            std::uint32_t size;   ///< The size of the payload that follows.
+        };
+
+        /**
+         * @brief Precedes the records that one flush took from one thread's ring.
+         */
+        struct trace_chunk_header
+        {
+            std::uint32_t magic;         ///< `trace_chunk_magic`.
+            std::uint32_t thread;        ///< The number of the emitting thread, in attach order.
+            std::uint64_t bytes;         ///< The size of the records that follow.
+            std::uint64_t dropped;       ///< Events lost to a full ring since the previous chunk of the thread.
+        };
+
+        inline constexpr std::uint32_t trace_chunk_magic = 0x4b4e4843; // "CHNK"
+
+        /**
+         * @brief The size a record takes, rounded up so that every header stays 8-byte aligned.
+         */
+        template <typename Event>
+        inline constexpr size_t trace_record_size = (sizeof(trace_record_header) + sizeof(Event) + 7) / 8 * 8;
+    }//end of namespace detail
+
+    /**
+     * @brief A decoded record, handed to the decoder's visitor next to the event itself.
+     */
+    struct trace_event_info
+    {
+        std::uint32_t thread = 0;   ///< The number of the emitting thread, in attach order.
+        std::uint64_t ticks = 0;    ///< The raw tick count.
+        std::int64_t nanoseconds = 0; ///< The tick count converted to `steady_clock` nanoseconds.
+    };
+
+    /**
+     * @brief What a decoded trace file contained.
+     */
+    struct trace_summary
+    {
+        std::uint64_t events = 0;  ///< Records handed to the visitor.
+        std::uint64_t dropped = 0; ///< Events lost to full rings while tracing.
+        std::uint64_t chunks = 0;  ///< Flushes of a thread's ring.
+    };
+
+    /**
+     * @brief Always-on binary tracing of typed events.
+     *
+     * The event types are the schema: an event's tag is its position in `Events`, and its
+     * payload is its object representation, so events must be trivially copyable. Every
+     * thread emits into its own single-producer ring; `emit` writes a 16-byte header (tick
+     * count and tag) and the payload, then publishes them with one release store. It never
+     * blocks or allocates after the first call on a thread: when the ring is full, the event
+     * is dropped and counted instead.
+     *
+     * `drain` moves whatever the rings hold to a stream, as chunks of records; a `flusher`
+     * does so on a background thread into a file, and `decode` reads such a file back with
+     * the same schema. All state is static, so the rings of one schema are shared by the
+     * whole program.
+     *
+     * @tparam Events A `type_list` of distinct, trivially copyable event types.
+     * @tparam RingBytes The capacity of each thread's ring, a power of two.
+     */
+    template <typename Events, size_t RingBytes = (size_t(1) << 16)>
+    class tracer;
+
+    template <typename... Events, size_t RingBytes>
+    class tracer<type_list<Events...>, RingBytes>
+    {
+    public:
+        using events = type_list<Events...>; ///< The event types, in tag order.
+
+        static_assert(sizeof...(Events) > 0, "a tracer needs at least one event type");
+        static_assert(detail::has_unique_types<events>::value, "trace event types must be distinct");
+        static_assert((is_trivially_copyable_v<Events> && ...), "trace events must be trivially copyable");
+        static_assert(std::has_single_bit(RingBytes) && RingBytes >= 64, "the ring capacity must be a power of two");
+        static_assert(((detail::trace_record_size<Events> <= RingBytes) && ...), "an event does not fit into the ring");
+
+        /**
+         * @brief The tag of an event type, i.e. its position in the schema.
+         */
+        template <typename Event>
+        static constexpr std::uint32_t tag = [] {
+            static_assert(index_of_v<Event, events> < sizeof...(Events), "event is not part of this trace schema");
+            return std::uint32_t(index_of_v<Event, events>);
+        }();
+
+        /**
+         * @brief Records an event on the calling thread's ring, or counts it as dropped if the ring is full.
+         */
+        template <typename Event>
+        static void emit(const Event& event) noexcept
+        {
+            constexpr size_t bytes = detail::trace_record_size<Event>;
+            ring* r = local;
+            if (r == nullptr) [[unlikely]]
+                r = attach();
+
+            const std::uint64_t head = r->head.load(std::memory_order_relaxed);
+            if (head + bytes - r->cached_tail > RingBytes) [[unlikely]]
+            {
+                r->cached_tail = r->tail.load(std::memory_order_acquire);
+                if (head + bytes - r->cached_tail > RingBytes)
+                {
+                    r->dropped.store(r->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            const detail::trace_record_header header{ detail::trace_ticks(), tag<Event>, std::uint32_t(sizeof(Event)) };
+            r->copy_in(head, &header, sizeof(header));
+            r->copy_in(head + sizeof(header), &event, sizeof(Event));
+            r->head.store(head + bytes, std::memory_order_release);
+        }
+
+        /**
+         * @brief Writes the file header: the schema that `decode` checks, and the tick rate calibration.
+         *
+         * The calibration pairs the clocks at the first attach with a reading taken now; if the two
+         * would lie less than `detail::trace_calibration_span` apart, this waits for the rest of it.
+         */
+        static void write_header(std::ostream& out)
+        {
+            const detail::trace_clock_pair& origin = detail::trace_clock_origin();
+            const std::uint64_t earliest = origin.ns + std::uint64_t(std::chrono::nanoseconds(detail::trace_calibration_span).count());
+            const std::uint64_t now = detail::trace_nanoseconds();
+            if (now < earliest)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(earliest - now));
+            const detail::trace_calibration calibration{ origin, detail::trace_clock_now() };
+            out.write(reinterpret_cast<const char*>(&schema_header), sizeof(schema_header));
+            out.write(reinterpret_cast<const char*>(&calibration), sizeof(calibration));
+        }
+
+        /**
+         * @brief Moves the records of every ring to `out`, one chunk per ring that has any.
+         *
+         * Rings of exited threads are released once they are empty. Concurrent calls are
+         * serialized; emitting threads are never blocked.
+         *
+         * @return The number of record bytes written.
+         */
+        static std::uint64_t drain(std::ostream& out)
+        {
+            std::uint64_t written = 0;
+            std::lock_guard lock(registry_mutex);
+            for (ring** link = &registry; *link != nullptr;)
+            {
+                ring* r = *link;
+                const bool finished = r->finished;
+                const std::uint64_t tail = r->tail.load(std::memory_order_relaxed);
+                const std::uint64_t head = r->head.load(std::memory_order_acquire);
+                const std::uint64_t dropped = r->dropped.load(std::memory_order_relaxed);
+                if (head != tail || dropped != r->dropped_reported)
+                {
+                    const detail::trace_chunk_header chunk{ detail::trace_chunk_magic, r->thread, head - tail,
+                        dropped - r->dropped_reported };
+                    out.write(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+                    r->copy_out(out, tail, head - tail);
+                    r->tail.store(head, std::memory_order_release);
+                    r->dropped_reported = dropped;
+                    written += head - tail;
+                }
+
+                if (finished)
+                {
+                    *link = r->next;
+                    delete r;
+                }
+                else
+                    link = &r->next;
+            }
+            return written;
+        }
+
+        /**
+         * @brief Background thread draining the rings into a file at a fixed interval.
+         *
+         * The file starts with `write_header`; the rings are drained one last time on destruction.
+         */
+        class flusher
+        {
+        public:
+            /**
+             * @param path The file to create or truncate.
+             * @param interval The time between two drains.
+             */
+            explicit flusher(const std::string& path, std::chrono::nanoseconds interval = std::chrono::milliseconds(10))
+                : file(path, std::ios::binary | std::ios::trunc), period(interval),
+                  worker([this](std::stop_token stop) { run(stop); }) {}
+
+            flusher(const flusher&) = delete;
+            flusher& operator=(const flusher&) = delete;
+
+            /**
+             * @brief Checks that the file could be opened and written so far.
+             */
+            bool good() const
+            {
+                std::lock_guard lock(file_mutex);
+                return file.good();
+            }
+
+            /**
+             * @brief Retrieves the number of record bytes written so far.
+             */
+            std::uint64_t bytes_written() const noexcept { return written.load(std::memory_order_relaxed); }
+
+        private:
+            void run(std::stop_token stop)
+            {
+                {
+                    std::lock_guard lock(file_mutex);
+                    write_header(file);
+                }
+                std::mutex wait_mutex;
+                std::condition_variable_any wakeup;
+                for (;;)
+                {
+                    const bool stopping = stop.stop_requested();
+                    {
+                        std::lock_guard lock(file_mutex);
+                        written.fetch_add(drain(file), std::memory_order_relaxed);
+                        file.flush();
+                    }
+                    if (stopping)
+                        return;
+
+                    std::unique_lock lock(wait_mutex);
+                    wakeup.wait_for(lock, stop, period, [] { return false; });
+                }
+            }
+
+            std::ofstream file;
+            mutable std::mutex file_mutex;
+            std::chrono::nanoseconds period;
+            std::atomic<std::uint64_t> written{ 0 };
+            std::jthread worker; ///< Declared last so that it stops before the members it uses are destroyed.
+        };
+
+        /**
+         * @brief Reads a trace written with this schema and calls `visitor(info, event)` for every record.
+         *
+         * The visitor must accept `(const trace_event_info&, const E&)` for every event type `E`,
+         * typically through an overload set or a generic lambda. Records are visited chunk by
+         * chunk, which keeps each thread's records in emission order. Tick counts are converted
+         * to nanoseconds by the line through the two clock pairs of the file's calibration.
+         *
+         * @return The summary, or `std::nullopt` if the input is not a trace of this schema.
+         */
+        template <typename Visitor>
+        static std::optional<trace_summary> decode(std::istream& in, Visitor&& visitor)
+        {
+            std::vector<char> bytes;
+            char buffer[1 << 16];
+            while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+                bytes.insert(bytes.end(), buffer, buffer + in.gcount());
+            const char* p = bytes.data();
+            const char* end = p + bytes.size();
+
+            if (size_t(end - p) < sizeof(schema_header) || std::memcmp(p, &schema_header, sizeof(schema_header)) != 0)
+                return std::nullopt;
+            p += sizeof(schema_header);
+
+            // The calibration and the chunk headers are copied out, as the buffer gives them no particular alignment.
+            detail::trace_calibration calibration;
+            if (size_t(end - p) < sizeof(calibration))
+                return std::nullopt;
+            std::memcpy(&calibration, p, sizeof(calibration));
+            p += sizeof(calibration);
+            if (calibration.sample.ticks <= calibration.origin.ticks || calibration.sample.ns <= calibration.origin.ns)
+                return std::nullopt;
+            const double ns_per_tick = double(calibration.sample.ns - calibration.origin.ns) /
+                double(calibration.sample.ticks - calibration.origin.ticks);
+            const std::int64_t base_ticks = std::int64_t(calibration.origin.ticks);
+            const std::int64_t base_ns = std::int64_t(calibration.origin.ns);
+
+            // First pass: validate the chunks, so that no record is visited from a truncated file.
+            std::vector<std::pair<detail::trace_chunk_header, const char*>> chunks;
+            for (const char* q = p; q != end;)
+            {
+                detail::trace_chunk_header chunk;
+                if (size_t(end - q) < sizeof(chunk))
+                    return std::nullopt;
+                std::memcpy(&chunk, q, sizeof(chunk));
+                if (chunk.magic != detail::trace_chunk_magic || chunk.bytes > size_t(end - q) - sizeof(chunk))
+                    return std::nullopt;
+                chunks.emplace_back(chunk, q + sizeof(chunk));
+                q += sizeof(chunk) + chunk.bytes;
+            }
+
+            trace_summary summary;
+            for (const auto& [chunk, payload] : chunks)
+            {
+                ++summary.chunks;
+                summary.dropped += chunk.dropped;
+                const char* record = payload;
+                const char* chunk_end = record + chunk.bytes;
+                while (record != chunk_end)
+                {
+                    detail::trace_record_header header;
+                    if (size_t(chunk_end - record) < sizeof(header))
+                        return std::nullopt;
+                    std::memcpy(&header, record, sizeof(header));
+
+                    trace_event_info info{ chunk.thread, header.ticks,
+                        base_ns + std::int64_t(double(std::int64_t(header.ticks) - base_ticks) * ns_per_tick) };
+                    size_t consumed = 0;
+                    visit_record(header, record + sizeof(header), size_t(chunk_end - record), info, visitor,
+                        consumed, make_index_sequence<sizeof...(Events)>{});
+                    if (consumed == 0)
+                        return std::nullopt;
+                    record += consumed;
+                    ++summary.events;
+                }
+            }
+            return summary;
+        }
+
+    private:
+        /**
+         * @brief The start of a trace file: the magic and the payload size of every event type.
+         *
+         * A `detail::trace_calibration` follows it.
+         */
+        struct file_header
+        {
+            char magic[8];
+            std::uint32_t count;
+            std::uint32_t sizes[sizeof...(Events)];
+        };
+
+        static constexpr file_header schema_header{
+            { 'M', 'K', 'T', 'R', 'A', 'C', 'E', '2' }, sizeof...(Events), { std::uint32_t(sizeof(Events))... } };
+
+        /**
+         * @brief A thread's ring; written by its thread, read and released by `drain`.
+         */
+        struct alignas(64) ring
+        {
+            alignas(64) std::atomic<std::uint64_t> head{ 0 }; ///< Bytes published by the owner.
+            std::uint64_t cached_tail = 0;                    ///< The owner's last view of `tail`.
+            std::atomic<std::uint64_t> dropped{ 0 };          ///< Events the owner could not fit.
+            alignas(64) std::atomic<std::uint64_t> tail{ 0 }; ///< Bytes consumed by `drain`.
+            std::uint64_t dropped_reported = 0;
+            std::uint32_t thread = 0;
+            bool finished = false;                            ///< Set under the registry lock at thread exit.
+            ring* next = nullptr;
+            alignas(64) char data[RingBytes];
+
+            void copy_in(std::uint64_t position, const void* from, size_t n) noexcept
+            {
+                const size_t offset = size_t(position & (RingBytes - 1));
+                const size_t first = n < RingBytes - offset ? n : RingBytes - offset;
+                std::memcpy(data + offset, from, first);
+                std::memcpy(data, static_cast<const char*>(from) + first, n - first);
+            }
+
+            void copy_out(std::ostream& out, std::uint64_t position, std::uint64_t n) const
+            {
+                const size_t offset = size_t(position & (RingBytes - 1));
+                const size_t first = n < RingBytes - offset ? size_t(n) : RingBytes - offset;
+                out.write(data + offset, std::streamsize(first));
+                out.write(data, std::streamsize(n - first));
+            }
+        };
+
+        /**
+         * @brief Marks the thread's ring as finished at thread exit, so that the next drain releases it.
+         */
+        struct detacher
+        {
+            ~detacher()
+            {
+                std::lock_guard lock(registry_mutex);
+                local->finished = true;
+            }
+        };
+
+        METAKIT_NOINLINE static ring* attach()
+        {
+            detail::trace_clock_origin();
+            ring* r = new ring;
+            {
+                std::lock_guard lock(registry_mutex);
+                r->thread = next_thread++;
+                r->next = registry;
+                registry = r;
+            }
+            local = r;
+            thread_local detacher on_exit;
+            return r;
+        }
+
+        template <typename Visitor, size_t... tags>
+        static void visit_record(const detail::trace_record_header& header, const char* payload, size_t available,
+            const trace_event_info& info, Visitor& visitor, size_t& consumed, index_sequence<tags...>)
+        {
+            (void)((header.tag == tags && (consumed = decode_one<at_t<events, tags>>(header, payload, available, info, visitor), true)) || ...);
+        }
+
+        template <typename Event, typename Visitor>
+        static size_t decode_one(const detail::trace_record_header& header, const char* payload, size_t available,
+            const trace_event_info& info, Visitor& visitor)
+        {
+            constexpr size_t bytes = detail::trace_record_size<Event>;
+            if (header.size != sizeof(Event) || available < bytes)
+                return 0;
+            struct { alignas(Event) char raw[sizeof(Event)]; } storage;
+            std::memcpy(storage.raw, payload, sizeof(Event));
+            visitor(info, std::bit_cast<Event>(storage));
+            return bytes;
+        }
+
+        static inline thread_local ring* local = nullptr;
+        static inline std::mutex registry_mutex;
+        static inline ring* registry = nullptr;
+        static inline std::uint32_t next_thread = 0;
+    };
+}
+
+#endif
@@ -1,13 +1,28 @@
 #ifndef TUPLE_H
 #define TUPLE_H
 
-#include "type_list.h"
+#include <type_traits>
 
-#ifndef HELPER__H
 #include "helper_.h"
-#endif 
+#include "type_list.h"
 
-using namespace metakit;
+#ifdef METAKIT_AUDIT_COPIES
+#include <source_location>
+
+#include "audit.h"
+
+// Adds the defaulted call site parameter of the audited operations and makes it current.
+#define METAKIT_AUDIT_SITE_PARAM , std::source_location audit_location = std::source_location::current()
+#define METAKIT_AUDIT_SITE() const detail::audit_site audit_site_{ audit_location }
+// For variadic operations, which cannot take the parameter: the operation itself, unless a site is current.
+#define METAKIT_AUDIT_FALLBACK_SITE() \
+    const std::source_location audit_location = std::source_location::current(); \
+    const detail::audit_site audit_site_{ audit_location, true }
+#else
+#define METAKIT_AUDIT_SITE_PARAM
+#define METAKIT_AUDIT_SITE()
+#define METAKIT_AUDIT_FALLBACK_SITE()
+#endif
 
 namespace metakit
 {
@@ -36,7 +51,13 @@ namespace metakit
          */
         template<typename T,typename ... Ts>
         explicit constexpr tuple(T&& e1, Ts&&... rest)
-            : tuple<element2...>(forward<Ts&&>(rest)...), data(forward<T>(e1)) {}
+            : tuple<element2...>(metakit::forward<Ts&&>(rest)...), data(metakit::forward<T>(e1))
+        {
+#ifdef METAKIT_AUDIT_COPIES
+            if (!std::is_constant_evaluated())
+                detail::audit_element<element1, T>();
+#endif
+        }
 
         element1 data; //Stores the data for the current tuple element.
     };
@@ -59,7 +80,8 @@ namespace metakit
     template<typename ... elements>
     constexpr auto make_tuple(elements&&... elem)
     {
-        return tuple<std::unwrap_ref_decay_t<elements>...>{forward<elements>(elem)...};
+        METAKIT_AUDIT_FALLBACK_SITE();
+        return tuple<std::unwrap_ref_decay_t<elements>...>{metakit::forward<elements>(elem)...};
     }
 
     namespace detail
@@ -93,9 +115,25 @@ namespace metakit
         template<typename Tuples>
         static constexpr size_t tuple_size_v = tuple_size<Tuples>::value;
 
+        /**
+         * @brief Adds the reference and const qualification of a forwarding reference type to a type.
+         *
+         * @tparam T The deduced forwarding reference type (`X&` for lvalues, `X` for rvalues).
+         * @tparam U The type to qualify.
+         */
+        template<typename T, typename U>
+        struct forward_like : if_<is_lvalue_reference_v<T>,
+            typename if_<is_const_v<remove_refernce_t<T>>, const U&, U&>::type,
+            typename if_<is_const_v<remove_refernce_t<T>>, const U&&, U&&>::type> {};
+
+        template<typename T, typename U>
+        using forward_like_t = typename forward_like<T, U>::type;
+
         /**
          * @brief Recursive implementation for accessing tuple elements by index.
          *
+         * Only computes types: `tuple_type` is the base of `Tuple` whose `data` member is element `i`.
+         *
          * @tparam i The index of the element to access.
          * @tparam Tuple The tuple type being accessed.
          */
@@ -110,30 +148,7 @@ namespace metakit
         template <typename Tuple>
         struct get_impl<0, Tuple>
         {
-            /**
-             * @brief Retrieves the element at the specified index from the tuple.
-             *
-             * @tparam T The type of the tuple instance.
-             * @param t The tuple instance from which the element will be retrieved.
-             * @return The element at the specified index, adjusted for reference and const-ness.
-             */
-            template<typename T>
-            constexpr static decltype(auto) get(T&& t)
-            {
-                constexpr bool is_lval = is_lvalue_reference_v<T>;
-                constexpr bool is_constant = is_const_v<remove_refernce_t<T>>;
-
-                using data_t = front_t<Tuple>;
-
-                if constexpr (is_lval && is_constant)
-                    return static_cast<const data_t&>(static_cast<const Tuple&>(t).data);//lvalue and constant
-                if constexpr (is_lval && !is_constant)
-                    return static_cast<data_t&>(static_cast<Tuple&>(t).data);//lvalue and not constant
-                if constexpr (!is_lval && is_constant)
-                    return static_cast<const data_t&&>(static_cast<const Tuple&&>(t).data);//rvalue and constant
-                if constexpr (!is_lval && !is_constant)
-                    return static_cast<data_t&&>(static_cast<Tuple&&>(t).data);//rvalue and not constant
-            }
+            using tuple_type = Tuple; ///< The tuple whose `data` member is the element.
         };
 
         /**
@@ -164,7 +179,7 @@ namespace metakit
              */
             template <typename fwd_tuple>
             static constexpr auto f(fwd_tuple&& fwd) {
-                return tuple{ get<indices>(forward<fwd_tuple>(fwd))... };
+                return tuple{ get<indices>(metakit::forward<fwd_tuple>(fwd))... };
             }
         };
 
@@ -180,7 +195,7 @@ namespace metakit
         template<typename ...T>
         static constexpr tuple<T&&...> forward_as_tuple(T&&... args)
         {
-            return tuple<T&&...>(forward<T>(args)...);
+            return tuple<T&&...>(metakit::forward<T>(args)...);
         };
 
         /**
@@ -216,8 +231,8 @@ namespace metakit
              */
             template <typename fwd_tuple, typename Tuple>
             static constexpr auto f(fwd_tuple&& fwd, Tuple&& t) {
-                return forward_as_tuple(get<fwd_indices>(forward<fwd_tuple>(fwd))...,
-                    get<indices>(forward<Tuple>(t))...);
+                return detail::forward_as_tuple(get<fwd_indices>(metakit::forward<fwd_tuple>(fwd))...,
+                    get<indices>(metakit::forward<Tuple>(t))...);
             }
         };
 
@@ -246,15 +261,15 @@ namespace metakit
             {
                 return f(concat_with_fwd_tuple<
                     make_index_sequence<tuple_size_v<remove_cvrf_t<rest_tuple>>>,
-                    make_index_sequence<tuple_size_v<remove_cvrf_t<Tuple>>>>::f(forward<rest_tuple>(rest),
-                                                                                     forward<Tuple>(t)),
-                    forward<Tuples>(ts)...);
+                    make_index_sequence<tuple_size_v<remove_cvrf_t<Tuple>>>>::f(metakit::forward<rest_tuple>(rest),
+                                                                                     metakit::forward<Tuple>(t)),
+                    metakit::forward<Tuples>(ts)...);
             }
 
             template<typename fwd_tuple>
             static constexpr auto f(fwd_tuple && rest)
             {
-                return make_tuple_from_fwd_tuple<make_index_sequence<tuple_size_v<fwd_tuple>>>::f(forward<fwd_tuple>(rest));
+                return make_tuple_from_fwd_tuple<make_index_sequence<tuple_size_v<fwd_tuple>>>::f(metakit::forward<fwd_tuple>(rest));
             }
         };
 
@@ -270,7 +285,7 @@ namespace metakit
         template<typename Tup, size_t... indecise>
         constexpr auto cat_tuple_content(Tup&& T, index_sequence<indecise...>)
         {
-            return tuple_cat(get<indecise>(forward<Tup>(T))...);
+            return tuple_cat(get<indecise>(metakit::forward<Tup>(T))...);
         }
 
 
@@ -287,7 +302,7 @@ namespace metakit
         template<typename Tup, typename Func, size_t ...indecise>
         constexpr auto transform_impl(Tup&& tup, Func&& func, index_sequence<indecise...>)
         {
-            return tuple{ func(get<indecise>(forward<Tup>(tup)))... };
+            return tuple{ func(get<indecise>(metakit::forward<Tup>(tup)))... };
         }
 
 
@@ -302,9 +317,14 @@ namespace metakit
      * @return The element at the specified index.
      */
     template<size_t i, typename Tuple>
-    constexpr decltype(auto) get(Tuple&& tuple)
-    {     
-        return detail::get_impl<i, remove_cvrf_t<Tuple>>::get(forward<Tuple>(tuple));
+    METAKIT_ALWAYS_INLINE constexpr decltype(auto) get(Tuple&& tuple) noexcept
+    {
+        // A single function of casts, so that unoptimized builds pay at most one call per access.
+        using tuple_t = typename detail::get_impl<i, remove_cvrf_t<Tuple>>::tuple_type;
+        using data_t = front_t<tuple_t>;
+
+        return static_cast<detail::forward_like_t<Tuple, data_t>>(
+            static_cast<detail::forward_like_t<Tuple, tuple_t>>(tuple).data);
     }
 
     /**
@@ -320,7 +340,8 @@ namespace metakit
     template<typename ... Tuple>
     constexpr decltype(auto) tuple_cat(Tuple&&... tuples)
     {
-        return detail::tuple_cat_impl::f(forward<Tuple>(tuples)...);
+        METAKIT_AUDIT_FALLBACK_SITE();
+        return detail::tuple_cat_impl::f(metakit::forward<Tuple>(tuples)...);
     }
 
 
@@ -334,9 +355,10 @@ namespace metakit
      * @return A new tuple with transformed elements.
      */
     template<typename Tup, typename Func>
-    constexpr auto transform(Tup&& tup, const Func& func)
+    constexpr auto transform(Tup&& tup, const Func& func METAKIT_AUDIT_SITE_PARAM)
     {
-        return detail::transform_impl(forward<Tup>(tup), func,
+        METAKIT_AUDIT_SITE();
+        return detail::transform_impl(metakit::forward<Tup>(tup), func,
             make_index_sequence<detail::tuple_size_v<remove_cvrf_t<Tup>>>{});
     }
     
@@ -349,8 +371,10 @@ namespace metakit
      * @return A new tuple containing only the elements that satisfy the predicate.
      */
     template<template<typename ...> class Pred, typename Tup>
-    constexpr auto filter(Tup&& t)
+    constexpr auto filter(Tup&& t METAKIT_AUDIT_SITE_PARAM)
     {
+        METAKIT_AUDIT_SITE();
+
         /**
          * @brief Wraps an element in a tuple if it matches the predicate.
          *
@@ -362,7 +386,7 @@ namespace metakit
         {
             if constexpr (Pred<remove_cvrf_t<Elem>>::value)
             {
-                return forward_as_tuple(forward<Elem>(e));
+                return detail::forward_as_tuple(metakit::forward<Elem>(e));
             }
             else
             {
@@ -371,14 +395,15 @@ namespace metakit
         };
 
         // Apply the wrapping function to each element in the tuple.
-        auto wrapped_tuple = transform(forward<Tup>(t), wrap_if_pred_matches);
+        auto wrapped_tuple = detail::transform_impl(metakit::forward<Tup>(t), wrap_if_pred_matches,
+            make_index_sequence<detail::tuple_size_v<remove_cvrf_t<Tup>>>{});
 
         /**
          * @brief Concatenates the wrapped tuples into a single tuple, removing empty ones.
          *
          * @return A filtered tuple containing only the elements that satisfy the predicate.
          */
-        return detail::cat_tuple_content(move(wrapped_tuple),
+        return detail::cat_tuple_content(metakit::move(wrapped_tuple),
             make_index_sequence<detail::tuple_size_v<remove_cvrf_t<Tup>>>{});
     }
 
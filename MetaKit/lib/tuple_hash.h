@@ -0,0 +1,165 @@
+#ifndef TUPLE_HASH_H
+#define TUPLE_HASH_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <type_traits>
+
+#include "tuple.h"
+
+namespace metakit
+{
+    namespace detail
+    {
+        /**
+         * @brief Spreads every input bit over the whole result (the murmur3 64-bit finalizer).
+         */
+        constexpr std::uint64_t hash_mix(std::uint64_t x) noexcept
+        {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ull;
+            x ^= x >> 33;
+            return x;
+        }
+
+        template<typename Tuple, size_t... indices>
+        std::uint64_t hash_tuple(const Tuple& t, index_sequence<indices...>) noexcept;
+
+        /**
+         * @brief Hashes one element: integers and floating point values by value, nested tuples
+         * recursively and everything else with `std::hash`.
+         *
+         * Equal floating point values hash equally, so -0.0 is hashed as 0.0.
+         */
+        template<typename T>
+        std::uint64_t element_hash(const T& e) noexcept
+        {
+            if constexpr (std::is_integral_v<T>)
+                return std::uint64_t(e);
+            else if constexpr (std::is_enum_v<T>)
+                return std::uint64_t(std::underlying_type_t<T>(e));
+            else if constexpr (std::is_same_v<T, double>)
+                return std::bit_cast<std::uint64_t>(e + 0.0);
+            else if constexpr (std::is_same_v<T, float>)
+                return std::bit_cast<std::uint32_t>(e + 0.0f);
+            else if constexpr (requires { tuple_size<T>::value; })
+                return hash_tuple(e, make_index_sequence<tuple_size_v<T>>{});
+            else
+                return std::uint64_t(std::hash<T>{}(e));
+        }
+
+        template<typename Tuple, size_t... indices>
+        std::uint64_t hash_tuple(const Tuple& t, index_sequence<indices...>) noexcept
+        {
+            std::uint64_t h = 0x9e3779b97f4a7c15ull;
+            ((h = hash_mix(h ^ element_hash(get<indices>(t)))), ...);
+            return h;
+        }
+
+        template<typename T>
+        constexpr bool element_equal(const T& a, const T& b);
+
+        template<typename Tuple, size_t... indices>
+        constexpr bool equal_tuple(const Tuple& a, const Tuple& b, index_sequence<indices...>)
+        {
+            return (element_equal(get<indices>(a), get<indices>(b)) && ...);
+        }
+
+        /**
+         * @brief Compares one element, nested tuples recursively.
+         */
+        template<typename T>
+        constexpr bool element_equal(const T& a, const T& b)
+        {
+            if constexpr (requires { tuple_size<T>::value; })
+                return equal_tuple(a, b, make_index_sequence<tuple_size_v<T>>{});
+            else
+                return a == b;
+        }
+    }//end of namespace detail
+
+    /**
+     * @brief Hashes a tuple or named tuple from the hashes of its elements, in order.
+     *
+     * Every bit of the result depends on every element, so the high bits can pick a shard
+     * and the low bits a slot.
+     */
+    template<typename Tuple>
+    std::uint64_t hash_value(const Tuple& t) noexcept
+    {
+        return detail::hash_tuple(t, make_index_sequence<detail::tuple_size_v<Tuple>>{});
+    }
+
+    /**
+     * @brief Hash function object for tuples, usable with standard and MetaKit containers.
+     */
+    struct tuple_hash
+    {
+        template<typename Tuple>
+        size_t operator()(const Tuple& t) const noexcept { return size_t(hash_value(t)); }
+    };
+
+    /**
+     * @brief Equality function object for tuples, comparing element by element.
+     *
+     * Consistent with `tuple_hash`: equal tuples have equal hashes.
+     */
+    struct tuple_equal
+    {
+        template<typename Tuple>
+        constexpr bool operator()(const Tuple& a, const Tuple& b) const
+        {
+            return detail::element_equal(a, b);
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Hints that the cache line at an address is used soon; `Write` if it is going to be written.
+         */
+        template<bool Write = false>
+        METAKIT_ALWAYS_INLINE void prefetch(const void* address) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address, Write ? 1 : 0);
+#else
+            (void)address;
+#endif
+        }
+
+        /**
+         * @brief The keys that `for_each_hash_batched` hashes ahead of their updates.
+         */
+        inline constexpr size_t hash_batch = 32;
+
+        /**
+         * @brief Hashes a block of keys with `hash_value`, calls `ahead(hash)` for all of them, then `update(hash, index)` for each.
+         *
+         * The independent hash computations overlap, and the memory that the updates touch is
+         * requested before the first of them waits for it.
+         */
+        template<typename Key, typename Prefetch, typename Update>
+        void for_each_hash_batched(std::span<const Key> keys, const Prefetch& ahead, const Update& update)
+        {
+            std::uint64_t hashes[hash_batch];
+            for (size_t begin = 0; begin < keys.size(); begin += hash_batch)
+            {
+                const size_t n = std::min(hash_batch, keys.size() - begin);
+                for (size_t i = 0; i < n; ++i)
+                    hashes[i] = hash_value(keys[begin + i]);
+                for (size_t i = 0; i < n; ++i)
+                    ahead(hashes[i]);
+                for (size_t i = 0; i < n; ++i)
+                    update(hashes[i], begin + i);
+            }
+        }
+    }//end of namespace detail
+}
+
+#endif
@@ -1,12 +1,8 @@
 #ifndef HEADER_H
 #define HEADER_H
 
-#include <string>
-
 #include "helper_.h"
 
-using namespace metakit;
-
 namespace metakit
 {
     /**
@@ -35,9 +31,6 @@ namespace metakit
     template <typename list>
     static constexpr bool empty_v = empty<list>::value;
 
-    static_assert(empty_v<type_list<>>);
-    static_assert(empty_v<type_list<int, bool>> == false);
-
     /**
      * @brief Trait to get the first element of a type list.
      */
@@ -56,8 +49,6 @@ namespace metakit
     template <typename list>
     using front_t = typename front<list>::type;
 
-    static_assert(is_same_v<front_t<type_list<int, bool, float>>, int>);
-
     /**
      * @brief Trait to remove the first type from a type list.
      */
@@ -76,8 +67,6 @@ namespace metakit
     template <typename list>
     using pop_front_t = typename pop_front<list>::type;
 
-    static_assert(is_same_v<pop_front_t<type_list<int, bool, float>>, type_list<bool, float>>);
-
     /**
      * @brief Trait to get the last element of a type list.
      */
@@ -96,9 +85,6 @@ namespace metakit
     template <typename list>
     using back_t = typename back<list>::type;
 
-    static_assert(is_same_v<back_t<type_list<int, bool, float>>, float>);
-    static_assert(is_same_v<back_t<type_list<int, bool>>, bool>);
-
     /**
      * @brief Trait to append a type to the back of a type list.
      */
@@ -117,9 +103,6 @@ namespace metakit
     template <typename list, typename T>
     using push_back_t = typename push_back<list, T>::type;
 
-    static_assert(is_same_v<push_back_t<type_list<>, int>, type_list<int>>);
-    static_assert(is_same_v<push_back_t<type_list<int, bool>, float>, type_list<int, bool, float>>);
-
     /**
      * @brief Trait to remove the last type from a type list.
      */
@@ -144,21 +127,83 @@ namespace metakit
     template <typename list>
     using pop_back_t = typename pop_back<list>::type;
 
-    static_assert(is_same_v<pop_back_t<type_list<int>>, type_list<>>);
-    static_assert(is_same_v<pop_back_t<type_list<int, bool, float>>, type_list<int, bool>>);
-    static_assert(is_same_v<pop_back_t<type_list<int, bool>>, type_list<int>>);
+    /**
+     * @brief Number of types in a type list.
+     */
+    template <typename list>
+    struct length;
 
     /**
-     * @brief Trait to get the type at a specific index in a type list.
+     * @brief Specialization to count the types of a list.
      */
-    template <typename list, size_t index>
-    struct at : has_type<typename at<pop_front_t<list>, index - 1>::type> {};
+    template <template <typename...> class list, typename... Ts>
+    struct length<list<Ts...>> : integral_constant<size_t, sizeof...(Ts)> {};
 
     /**
-     * @brief Specialization for index 0.
+     * @brief Constant holding the number of types in a type list.
      */
     template <typename list>
-    struct at<list, 0> : has_type<front_t<list>> {};
+    static constexpr size_t length_v = length<list>::value;
+
+    namespace detail
+    {
+        /**
+         * @brief Associates a type with its position in a list.
+         */
+        template <size_t index, typename T>
+        struct indexed : has_type<T> {};
+
+        /**
+         * @brief Inherits one `indexed` base per element, so any element can be found by overload resolution.
+         */
+        template <typename indices, typename... Ts>
+        struct indexer;
+
+        template <size_t... indices, typename... Ts>
+        struct indexer<index_sequence<indices...>, Ts...> : indexed<indices, Ts>... {};
+
+        /**
+         * @brief Builds the `indexer` of a type list; it is instantiated once per list.
+         */
+        template <typename list>
+        struct make_indexer;
+
+        template <template <typename...> class list, typename... Ts>
+        struct make_indexer<list<Ts...>> : has_type<indexer<make_index_sequence<sizeof...(Ts)>, Ts...>> {};
+
+        /**
+         * @brief Selects the `indexed` base for `index`; only used in unevaluated context.
+         */
+        template <size_t index, typename T>
+        indexed<index, T> select(const indexed<index, T>*);
+
+        /**
+         * @brief The type at `index` in `list`, found in constant instantiation depth.
+         */
+        template <typename list, size_t index>
+        struct select_in;
+
+#if METAKIT_HAS_BUILTIN(__type_pack_element)
+        template <template <typename...> class list, typename... Ts, size_t index>
+        struct select_in<list<Ts...>, index> : has_type<__type_pack_element<index, Ts...>> {};
+#else
+        template <template <typename...> class list, typename... Ts, size_t index>
+        struct select_in<list<Ts...>, index>
+            : decltype(select<index>(static_cast<const typename make_indexer<list<Ts...>>::type*>(nullptr))) {};
+#endif
+
+        template <typename list, size_t index>
+        using select_t = typename select_in<list, index>::type;
+    }
+
+    /**
+     * @brief Trait to get the type at a specific index in a type list.
+     *
+     * The lookup goes through the list's `indexer`, so its cost does not grow with `index`.
+     */
+    template <typename list, size_t index>
+    requires(index < length_v<list>)
+    struct at : has_type<detail::select_t<list, index>> {};
 
     /**
      * @brief Alias to get the type at a specific index.
@@ -166,9 +211,6 @@ namespace metakit
     template <typename list, size_t index>
     using at_t = typename at<list, index>::type;
 
-    static_assert(is_same_v<at_t<type_list<int, bool, float>, 1>, bool>);
-    static_assert(is_same_v<at_t<type_list<int, bool, float>, 2>, float>);
-
     /**
      * @brief Trait to check if any type in a list satisfies a predicate.
      */
@@ -196,10 +238,6 @@ namespace metakit
     template <template <typename> class Pred, typename list>
     static constexpr bool any_v = any<Pred, list>::value;
 
-    static_assert(any_v<is_integral, type_list<int, double, std::string>>);
-    static_assert(any_v<is_integral, type_list<std::string, double, int>>);
-    static_assert(!any_v<is_integral, type_list<std::string, double, float>>);
-
     /**
      * @brief Predicate to check if types are the same.
      */
@@ -215,6 +253,237 @@ namespace metakit
      */
     template<typename search, typename list>
     static constexpr bool contains_type_v = any<is_same_pred<search>::template predicate, list>::value;
+
+    /**
+     * @brief Trait to join type lists of the same kind into one.
+     */
+    template <typename... lists>
+    struct concat;
+
+    /**
+     * @brief Specialization for a single list.
+     */
+    template <template <typename...> class list, typename... T1>
+    struct concat<list<T1...>> : has_type<list<T1...>> {};
+
+    /**
+     * @brief Specialization joining two lists.
+     */
+    template <template <typename...> class list, typename... T1, typename... T2>
+    struct concat<list<T1...>, list<T2...>> : has_type<list<T1..., T2...>> {};
+
+    /**
+     * @brief Specialization joining three or more lists.
+     */
+    template <template <typename...> class list, typename... T1, typename... T2, typename... T3, typename... rest>
+    struct concat<list<T1...>, list<T2...>, list<T3...>, rest...> : concat<list<T1..., T2..., T3...>, rest...> {};
+
+    /**
+     * @brief Alias to join type lists.
+     */
+    template <typename... lists>
+    using concat_t = typename concat<lists...>::type;
+
+    namespace detail
+    {
+        /**
+         * @brief Computes the position of `T` among `Ts`, or `sizeof...(Ts)` if absent.
+         */
+        template <typename T, typename... Ts>
+        constexpr size_t index_of_impl()
+        {
+            constexpr bool matches[] = { is_same_v<T, Ts>..., false };
+            size_t i = 0;
+            while (i < sizeof...(Ts) && !matches[i])
+                ++i;
+            return i;
+        }
+    }
+
+    /**
+     * @brief Trait to find the position of the first occurrence of a type in a type list.
+     *
+     * Yields the length of the list when the type does not occur.
+     */
+    template <typename T, typename list>
+    struct index_of;
+
+    /**
+     * @brief Specialization searching the elements of a list.
+     */
+    template <typename T, template <typename...> class list, typename... Ts>
+    struct index_of<T, list<Ts...>> : integral_constant<size_t, detail::index_of_impl<T, Ts...>()> {};
+
+    /**
+     * @brief Constant holding the position of a type in a type list.
+     */
+    template <typename T, typename list>
+    static constexpr size_t index_of_v = index_of<T, list>::value;
+
+    namespace detail
+    {
+        /**
+         * @brief Checks that no type occurs twice in a type list.
+         *
+         * Each type's first occurrence is at most its own position, so the positions only add
+         * up to 0 + 1 + ... + (n - 1) when every type occurs once.
+         */
+        template <typename list>
+        struct has_unique_types;
+
+        template <template <typename...> class list, typename... Ts>
+        struct has_unique_types<list<Ts...>>
+            : bool_constant<(index_of_v<Ts, list<Ts...>> + ... + size_t(0)) == sizeof...(Ts) * (sizeof...(Ts) - 1) / 2> {};
+    }
+
+    namespace detail
+    {
+        /**
+         * @brief Builds a list from the elements of `list` at the given indices.
+         *
+         * Every structural operation below is a `gather` over a computed index sequence, so it
+         * costs one `indexer` plus one overload resolution per result element, with no recursion.
+         */
+        template <typename list, typename indices>
+        struct gather;
+
+        template <template <typename...> class list, typename... Ts, size_t... indices>
+        struct gather<list<Ts...>, index_sequence<indices...>> : has_type<list<select_t<list<Ts...>, indices>...>> {};
+
+        /**
+         * @brief Applies `map::apply` to every index of `0 .. n-1`.
+         */
+        template <typename map, typename indices>
+        struct map_indices;
+
+        template <typename map, size_t... indices>
+        struct map_indices<map, index_sequence<indices...>> : has_type<index_sequence<map::apply(indices)...>> {};
+
+        /**
+         * @brief Gathers `n` elements, taking result element `i` from source index `map::apply(i)`.
+         */
+        template <typename list, typename map, size_t n>
+        using gather_t = typename gather<list, typename map_indices<map, make_index_sequence<n>>::type>::type;
+
+        template <size_t n>
+        struct reverse_map { static constexpr size_t apply(size_t i) { return n - 1 - i; } };
+
+        template <size_t offset>
+        struct offset_map { static constexpr size_t apply(size_t i) { return offset + i; } };
+
+        template <size_t n, size_t k>
+        struct rotate_map { static constexpr size_t apply(size_t i) { return (i + k) % n; } };
+
+        template <size_t index>
+        struct erase_map { static constexpr size_t apply(size_t i) { return i < index ? i : i + 1; } };
+
+        /**
+         * @brief Splits a list into consecutive slices of `n` elements.
+         */
+        template <typename list, size_t n, typename chunk_indices>
+        struct chunk_impl;
+    }
+
+    /**
+     * @brief Trait to reverse the order of a type list.
+     */
+    template <typename list>
+    struct reverse : has_type<detail::gather_t<list, detail::reverse_map<length_v<list>>, length_v<list>>> {};
+
+    /**
+     * @brief Alias to reverse a type list.
+     */
+    template <typename list>
+    using reverse_t = typename reverse<list>::type;
+
+    /**
+     * @brief Trait to take the elements in the index range [begin, end) of a type list.
+     */
+    template <typename list, size_t begin, size_t end>
+    requires(begin <= end && end <= length_v<list>)
+    struct slice : has_type<detail::gather_t<list, detail::offset_map<begin>, end - begin>> {};
+
+    /**
+     * @brief Alias to take the elements in the index range [begin, end) of a type list.
+     */
+    template <typename list, size_t begin, size_t end>
+    using slice_t = typename slice<list, begin, end>::type;
+
+    /**
+     * @brief Trait to insert a type before position `index` of a type list.
+     */
+    template <typename list, size_t index, typename T>
+    struct insert_at;
+
+    /**
+     * @brief Specialization splicing the type between the two halves of the list.
+     */
+    template <template <typename...> class list, typename... Ts, size_t index, typename T>
+    requires(index <= sizeof...(Ts))
+    struct insert_at<list<Ts...>, index, T>
+        : concat<slice_t<list<Ts...>, 0, index>, list<T>, slice_t<list<Ts...>, index, sizeof...(Ts)>> {};
+
+    /**
+     * @brief Alias to insert a type before position `index` of a type list.
+     */
+    template <typename list, size_t index, typename T>
+    using insert_at_t = typename insert_at<list, index, T>::type;
+
+    /**
+     * @brief Trait to remove the type at position `index` of a type list.
+     */
+    template <typename list, size_t index>
+    requires(index < length_v<list>)
+    struct erase_at : has_type<detail::gather_t<list, detail::erase_map<index>, length_v<list> - 1>> {};
+
+    /**
+     * @brief Alias to remove the type at position `index` of a type list.
+     */
+    template <typename list, size_t index>
+    using erase_at_t = typename erase_at<list, index>::type;
+
+    /**
+     * @brief Trait to rotate a type list left by `k` positions.
+     *
+     * The element at index `k % length` becomes the front of the result.
+     */
+    template <typename list, size_t k>
+    struct rotate : has_type<detail::gather_t<list, detail::rotate_map<length_v<list>, k>, length_v<list>>> {};
+
+    /**
+     * @brief Specialization for rotating an empty list.
+     */
+    template <template <typename...> class list, size_t k>
+    struct rotate<list<>, k> : has_type<list<>> {};
+
+    /**
+     * @brief Alias to rotate a type list left by `k` positions.
+     */
+    template <typename list, size_t k>
+    using rotate_t = typename rotate<list, k>::type;
+
+    namespace detail
+    {
+        template <template <typename...> class list, typename... Ts, size_t n, size_t... chunk_indices>
+        struct chunk_impl<list<Ts...>, n, index_sequence<chunk_indices...>>
+            : has_type<list<slice_t<list<Ts...>, chunk_indices * n,
+                (chunk_indices * n + n < sizeof...(Ts) ? chunk_indices * n + n : sizeof...(Ts))>...>> {};
+    }
+
+    /**
+     * @brief Trait to split a type list into a list of consecutive groups of `n` types.
+     *
+     * The last group holds the remaining types when the length is not a multiple of `n`.
+     */
+    template <typename list, size_t n>
+    requires(n > 0)
+    struct chunk : detail::chunk_impl<list, n, make_index_sequence<(length_v<list> + n - 1) / n>> {};
+
+    /**
+     * @brief Alias to split a type list into groups of `n` types.
+     */
+    template <typename list, size_t n>
+    using chunk_t = typename chunk<list, n>::type;
 }
 
 #endif
\ No newline at end of file
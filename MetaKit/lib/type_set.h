@@ -0,0 +1,238 @@
+#ifndef TYPE_SET_H
+#define TYPE_SET_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "type_list.h"
+
+namespace metakit
+{
+    /**
+     * @brief A set of types drawn from a fixed universe, stored as a bitmask.
+     *
+     * Bit `i` is set when the `i`-th type of `Universe` is a member. Union, intersection,
+     * difference and inclusion are word-wise bit operations, and enumeration visits set bits
+     * only. Every operation is `constexpr`, so the same type serves sets known at compile time
+     * (including as a template argument, see `to_type_list_t`) and sets built at run time.
+     *
+     * @tparam Universe The type list of all possible members; its types must be distinct.
+     */
+    template <typename Universe>
+    struct type_set
+    {
+        using universe = Universe;          ///< The type list of all possible members.
+        using word_type = std::uint64_t;    ///< The storage word of the bitmask.
+
+        static constexpr size_t universe_size = length_v<Universe>;                       ///< The number of possible members.
+        static constexpr size_t word_bits = sizeof(word_type) * 8;                        ///< The number of members per word.
+        static constexpr size_t word_count = (universe_size + word_bits - 1) / word_bits; ///< The number of words.
+
+        static_assert(detail::has_unique_types<Universe>::value, "type_set universe must not contain duplicate types");
+
+        std::array<word_type, word_count> words{}; ///< The bitmask; public so that the set is a structural type.
+
+        /**
+         * @brief Creates the set holding exactly the given types.
+         */
+        template <typename... Ts>
+        static constexpr type_set of() noexcept
+        {
+            type_set set;
+            (set.template insert<Ts>(), ...);
+            return set;
+        }
+
+        /**
+         * @brief Creates the set holding the types of a type list.
+         */
+        template <typename list>
+        static constexpr type_set from_list() noexcept
+        {
+            return from_list_impl(static_cast<list*>(nullptr));
+        }
+
+        /**
+         * @brief Creates the set holding every type of the universe.
+         */
+        static constexpr type_set all() noexcept
+        {
+            type_set set;
+            for (size_t i = 0; i < universe_size; ++i)
+                set.insert(i);
+            return set;
+        }
+
+        /**
+         * @brief Retrieves the position of a type in the universe.
+         */
+        template <typename T>
+        static constexpr size_t index_of() noexcept
+        {
+            constexpr size_t index = index_of_v<T, Universe>;
+            static_assert(index < universe_size, "type is not part of the type_set universe");
+            return index;
+        }
+
+        template <typename T>
+        constexpr bool contains() const noexcept { return contains(index_of<T>()); }
+
+        constexpr bool contains(size_t index) const noexcept
+        {
+            return (words[index / word_bits] >> (index % word_bits)) & 1u;
+        }
+
+        template <typename T>
+        constexpr void insert() noexcept { insert(index_of<T>()); }
+
+        constexpr void insert(size_t index) noexcept
+        {
+            words[index / word_bits] |= word_type(1) << (index % word_bits);
+        }
+
+        template <typename T>
+        constexpr void erase() noexcept { erase(index_of<T>()); }
+
+        constexpr void erase(size_t index) noexcept
+        {
+            words[index / word_bits] &= ~(word_type(1) << (index % word_bits));
+        }
+
+        /**
+         * @brief Retrieves the number of members.
+         */
+        constexpr size_t size() const noexcept
+        {
+            size_t count = 0;
+            for (word_type word : words)
+                count += size_t(std::popcount(word));
+            return count;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            for (word_type word : words)
+                if (word != 0)
+                    return false;
+            return true;
+        }
+
+        /**
+         * @brief Checks if every member of `other` is also a member of this set.
+         */
+        constexpr bool includes(const type_set& other) const noexcept
+        {
+            for (size_t w = 0; w < word_count; ++w)
+                if ((other.words[w] & ~words[w]) != 0)
+                    return false;
+            return true;
+        }
+
+        /**
+         * @brief Calls `f(index)` for the universe index of every member, in ascending order.
+         */
+        template <typename F>
+        constexpr void for_each_index(F&& f) const
+        {
+            for (size_t w = 0; w < word_count; ++w)
+                for (word_type bits = words[w]; bits != 0; bits &= bits - 1)
+                    f(w * word_bits + size_t(std::countr_zero(bits)));
+        }
+
+        /**
+         * @brief Calls `f(has_type<T>{})` for every member type `T`, in universe order.
+         *
+         * Only set bits are visited; each one dispatches through a table with one entry per
+         * universe type.
+         */
+        template <typename F>
+        constexpr void for_each(F&& f) const
+        {
+            constexpr auto table = make_dispatch_table<F>(make_index_sequence<universe_size>{});
+            for_each_index([&](size_t index) { table[index](f); });
+        }
+
+        constexpr type_set& operator|=(const type_set& other) noexcept
+        {
+            for (size_t w = 0; w < word_count; ++w)
+                words[w] |= other.words[w];
+            return *this;
+        }
+
+        constexpr type_set& operator&=(const type_set& other) noexcept
+        {
+            for (size_t w = 0; w < word_count; ++w)
+                words[w] &= other.words[w];
+            return *this;
+        }
+
+        constexpr type_set& operator-=(const type_set& other) noexcept
+        {
+            for (size_t w = 0; w < word_count; ++w)
+                words[w] &= ~other.words[w];
+            return *this;
+        }
+
+        friend constexpr type_set operator|(type_set lhs, const type_set& rhs) noexcept { return lhs |= rhs; }
+        friend constexpr type_set operator&(type_set lhs, const type_set& rhs) noexcept { return lhs &= rhs; }
+        friend constexpr type_set operator-(type_set lhs, const type_set& rhs) noexcept { return lhs -= rhs; }
+        friend constexpr bool operator==(const type_set&, const type_set&) noexcept = default;
+
+    private:
+        template <template <typename...> class list, typename... Ts>
+        static constexpr type_set from_list_impl(list<Ts...>*) noexcept
+        {
+            return of<Ts...>();
+        }
+
+        template <typename F, size_t index>
+        static constexpr void dispatch(F& f)
+        {
+            f(has_type<at_t<Universe, index>>{});
+        }
+
+        template <typename F, size_t... indices>
+        static constexpr auto make_dispatch_table(index_sequence<indices...>)
+        {
+            return std::array<void (*)(F&), sizeof...(indices)>{ &dispatch<F, indices>... };
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief The universe indices of the members of a compile-time set.
+         */
+        template <auto set>
+        struct set_members
+        {
+            static constexpr std::array<size_t, set.size()> indices = []
+            {
+                std::array<size_t, set.size()> result{};
+                size_t n = 0;
+                set.for_each_index([&](size_t index) { result[n++] = index; });
+                return result;
+            }();
+        };
+
+        template <auto set, typename positions>
+        struct set_to_list;
+
+        template <auto set, size_t... positions>
+        struct set_to_list<set, index_sequence<positions...>>
+            : gather<typename decltype(set)::universe, index_sequence<set_members<set>::indices[positions]...>> {};
+    }
+
+    /**
+     * @brief Converts a compile-time `type_set` value back into a type list of its members.
+     *
+     * The result uses the list template of the universe and keeps universe order.
+     *
+     * @tparam set The set value.
+     */
+    template <auto set>
+    using to_type_list_t = typename detail::set_to_list<set, make_index_sequence<set.size()>>::type;
+}
+
+#endif
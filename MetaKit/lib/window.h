@@ -0,0 +1,393 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "tuple.h"
+#include "type_list.h"
+
+/**
+ * @brief Incremental aggregation over time windows of a stream of tuples.
+ *
+ * A window operator is declared with the record type, the index of its time element and a
+ * `type_list` of aggregators, each naming the element it aggregates:
+ *
+ *     using trade = tuple<std::int64_t, double, std::int32_t>; // time, price, quantity
+ *     sliding_window<trade, 0, type_list<aggregate::sum<2>, aggregate::min<1>, aggregate::count>> w(60'000);
+ *     const auto values = w.push(t); // get<0>(values) is the volume, get<1> the low, get<2> the trade count
+ *
+ * Every update costs O(1) amortized per aggregator, whatever the window size: invertible
+ * aggregates (sum, count, mean) add records on insertion and subtract them on eviction, and
+ * min / max keep a monotonic deque whose front is the answer. Records must arrive in
+ * non-decreasing time order.
+ *
+ * An aggregator is a type with a nested `state<Tuple>` that has `insert(record, sequence)`,
+ * `evict(record, sequence)`, `reset()` and `value()`; records are evicted in the order they
+ * were inserted, and `sequence` numbers them from 0 in that order.
+ */
+
+namespace metakit
+{
+    namespace aggregate
+    {
+        namespace detail
+        {
+            /**
+             * @brief The type that sums elements of type `T` without overflowing as soon as `T` would.
+             */
+            template<typename T>
+            using sum_t = std::conditional_t<std::is_floating_point_v<T>, double,
+                std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+
+            template<size_t I, typename Tuple>
+            using element_t = remove_cvrf_t<decltype(get<I>(std::declval<const Tuple&>()))>;
+
+            /**
+             * @brief The extremum of element `I` of the records in the window, with a monotonic deque.
+             *
+             * The deque holds the records that can still become the extremum, from oldest to newest,
+             * with values in strictly `Better` order: an insertion first drops the newer records it
+             * beats, and an eviction drops the front if it is the evicted record. Each record enters
+             * and leaves the deque once.
+             */
+            template<size_t I, typename Tuple, typename Better>
+            struct extremum_state
+            {
+                using value_type = element_t<I, Tuple>;
+
+                std::deque<std::pair<std::uint64_t, value_type>> candidates;
+
+                void insert(const Tuple& record, std::uint64_t sequence)
+                {
+                    const value_type& v = get<I>(record);
+                    while (!candidates.empty() && !Better{}(candidates.back().second, v))
+                        candidates.pop_back();
+                    candidates.emplace_back(sequence, v);
+                }
+
+                void evict(const Tuple&, std::uint64_t sequence) noexcept
+                {
+                    if (!candidates.empty() && candidates.front().first == sequence)
+                        candidates.pop_front();
+                }
+
+                void reset() noexcept { candidates.clear(); }
+
+                /**
+                 * @brief The extremum; the window must not be empty.
+                 */
+                value_type value() const noexcept { return candidates.front().second; }
+            };
+
+            struct less
+            {
+                template<typename T>
+                constexpr bool operator()(const T& a, const T& b) const { return a < b; }
+            };
+
+            struct greater
+            {
+                template<typename T>
+                constexpr bool operator()(const T& a, const T& b) const { return b < a; }
+            };
+        }//end of namespace detail
+
+        /**
+         * @brief The number of records in the window.
+         */
+        struct count
+        {
+            template<typename Tuple>
+            struct state
+            {
+                std::uint64_t n = 0;
+
+                void insert(const Tuple&, std::uint64_t) noexcept { ++n; }
+                void evict(const Tuple&, std::uint64_t) noexcept { --n; }
+                void reset() noexcept { n = 0; }
+                std::uint64_t value() const noexcept { return n; }
+            };
+        };
+
+        /**
+         * @brief The sum of element `I`, in `double`, `std::int64_t` or `std::uint64_t`.
+         *
+         * Floating point sums subtract evicted values, so they can drift from a recomputed sum
+         * by rounding errors; integer sums are exact.
+         */
+        template<size_t I>
+        struct sum
+        {
+            template<typename Tuple>
+            struct state
+            {
+                detail::sum_t<detail::element_t<I, Tuple>> total{};
+
+                void insert(const Tuple& record, std::uint64_t) noexcept { total += get<I>(record); }
+                void evict(const Tuple& record, std::uint64_t) noexcept { total -= get<I>(record); }
+                void reset() noexcept { total = {}; }
+                auto value() const noexcept { return total; }
+            };
+        };
+
+        /**
+         * @brief The mean of element `I`, as a `double`; the window must not be empty.
+         */
+        template<size_t I>
+        struct mean
+        {
+            template<typename Tuple>
+            struct state
+            {
+                typename sum<I>::template state<Tuple> total;
+                std::uint64_t n = 0;
+
+                void insert(const Tuple& record, std::uint64_t sequence) noexcept { total.insert(record, sequence); ++n; }
+                void evict(const Tuple& record, std::uint64_t sequence) noexcept { total.evict(record, sequence); --n; }
+                void reset() noexcept { total.reset(); n = 0; }
+                double value() const noexcept { return double(total.value()) / double(n); }
+            };
+        };
+
+        /**
+         * @brief The smallest element `I`.
+         */
+        template<size_t I>
+        struct min
+        {
+            template<typename Tuple>
+            struct state : detail::extremum_state<I, Tuple, detail::less> {};
+        };
+
+        /**
+         * @brief The largest element `I`.
+         */
+        template<size_t I>
+        struct max
+        {
+            template<typename Tuple>
+            struct state : detail::extremum_state<I, Tuple, detail::greater> {};
+        };
+    }//end of namespace aggregate
+
+    namespace detail
+    {
+        template<typename Tuple, typename Aggregators>
+        struct window_states;
+
+        /**
+         * @brief The states of a list of aggregators, updated together.
+         */
+        template<typename Tuple, typename... Aggregators>
+        struct window_states<Tuple, type_list<Aggregators...>>
+        {
+            using states_type = tuple<typename Aggregators::template state<Tuple>...>;
+            using values_type = tuple<decltype(std::declval<const typename Aggregators::template state<Tuple>&>().value())...>;
+            using indices = make_index_sequence<sizeof...(Aggregators)>;
+
+            states_type states{ typename Aggregators::template state<Tuple>{}... };
+
+            void insert(const Tuple& record, std::uint64_t sequence)
+            {
+                [&]<size_t... is>(index_sequence<is...>) { (get<is>(states).insert(record, sequence), ...); }(indices{});
+            }
+
+            void evict(const Tuple& record, std::uint64_t sequence)
+            {
+                [&]<size_t... is>(index_sequence<is...>) { (get<is>(states).evict(record, sequence), ...); }(indices{});
+            }
+
+            void reset()
+            {
+                [&]<size_t... is>(index_sequence<is...>) { (get<is>(states).reset(), ...); }(indices{});
+            }
+
+            values_type values() const
+            {
+                return [&]<size_t... is>(index_sequence<is...>) { return values_type(get<is>(states).value()...); }(indices{});
+            }
+        };
+    }//end of namespace detail
+
+    /**
+     * @brief The aggregates of one closed window.
+     */
+    template<typename Time, typename Values>
+    struct window_result
+    {
+        Time start;            ///< The start of the window (tumbling) or the time of its first record (session).
+        Time end;              ///< The end of the window, exclusive (tumbling) or the time of its last record (session).
+        std::uint64_t records; ///< The number of records in the window.
+        Values values;         ///< The value of every aggregator, in list order.
+    };
+
+    /**
+     * @brief Aggregates the records of the last `size` time units, updated on every record.
+     *
+     * @tparam Tuple The record type.
+     * @tparam TimeIndex The index of the record's time, an arithmetic element.
+     * @tparam Aggregators A `type_list` of aggregators.
+     */
+    template<typename Tuple, size_t TimeIndex, typename Aggregators>
+    class sliding_window
+    {
+        using states_type = detail::window_states<Tuple, Aggregators>;
+
+    public:
+        using time_type = aggregate::detail::element_t<TimeIndex, Tuple>;
+        using values_type = typename states_type::values_type;
+
+        explicit sliding_window(time_type size) : size_(size) {}
+
+        /**
+         * @brief Adds a record, evicts those `size` or more time units older, and retrieves the aggregates.
+         */
+        values_type push(const Tuple& record)
+        {
+            const time_type now = get<TimeIndex>(record);
+            while (!records_.empty() && get<TimeIndex>(records_.front()) + size_ <= now)
+            {
+                states_.evict(records_.front(), first_++);
+                records_.pop_front();
+            }
+            states_.insert(record, first_ + records_.size());
+            records_.push_back(record);
+            return states_.values();
+        }
+
+        size_t size() const noexcept { return records_.size(); }
+
+        /**
+         * @brief Retrieves the aggregates of the records currently in the window, which must not be empty.
+         */
+        values_type values() const { return states_.values(); }
+
+    private:
+        time_type size_;
+        std::deque<Tuple> records_;
+        std::uint64_t first_ = 0;
+        states_type states_;
+    };
+
+    /**
+     * @brief Aggregates records in consecutive windows `[k * size, (k + 1) * size)`, reporting each when it closes.
+     */
+    template<typename Tuple, size_t TimeIndex, typename Aggregators>
+    class tumbling_window
+    {
+        using states_type = detail::window_states<Tuple, Aggregators>;
+
+    public:
+        using time_type = aggregate::detail::element_t<TimeIndex, Tuple>;
+        using result_type = window_result<time_type, typename states_type::values_type>;
+
+        explicit tumbling_window(time_type size) : size_(size) {}
+
+        /**
+         * @brief Adds a record.
+         *
+         * @return The previous window if this record is past its end; windows without records are skipped.
+         */
+        std::optional<result_type> push(const Tuple& record)
+        {
+            const time_type now = get<TimeIndex>(record);
+            std::optional<result_type> closed;
+            if (count_ != 0 && now >= start_ + size_)
+                closed = flush();
+            if (count_ == 0)
+                start_ = window_start(now);
+            states_.insert(record, count_++);
+            return closed;
+        }
+
+        /**
+         * @brief Closes the current window, if it has records.
+         */
+        std::optional<result_type> flush()
+        {
+            if (count_ == 0)
+                return std::nullopt;
+            result_type result{ start_, time_type(start_ + size_), count_, states_.values() };
+            states_.reset();
+            count_ = 0;
+            return result;
+        }
+
+    private:
+        /**
+         * @brief Rounds a time down to a multiple of the window size, negative times included.
+         */
+        time_type window_start(time_type now) const noexcept
+        {
+            if constexpr (std::is_floating_point_v<time_type>)
+                return time_type(std::floor(now / size_) * size_);
+            else
+                return time_type(now - ((now % size_) + size_) % size_);
+        }
+
+        time_type size_;
+        time_type start_{};
+        std::uint64_t count_ = 0;
+        states_type states_;
+    };
+
+    /**
+     * @brief Aggregates bursts of records, a window closing when no record arrives for more than `gap` time units.
+     */
+    template<typename Tuple, size_t TimeIndex, typename Aggregators>
+    class session_window
+    {
+        using states_type = detail::window_states<Tuple, Aggregators>;
+
+    public:
+        using time_type = aggregate::detail::element_t<TimeIndex, Tuple>;
+        using result_type = window_result<time_type, typename states_type::values_type>;
+
+        explicit session_window(time_type gap) : gap_(gap) {}
+
+        /**
+         * @brief Adds a record.
+         *
+         * @return The previous session if this record comes more than `gap` after its last record.
+         */
+        std::optional<result_type> push(const Tuple& record)
+        {
+            const time_type now = get<TimeIndex>(record);
+            std::optional<result_type> closed;
+            if (count_ != 0 && now > last_ + gap_)
+                closed = flush();
+            if (count_ == 0)
+                start_ = now;
+            last_ = now;
+            states_.insert(record, count_++);
+            return closed;
+        }
+
+        /**
+         * @brief Closes the current session, if it has records.
+         */
+        std::optional<result_type> flush()
+        {
+            if (count_ == 0)
+                return std::nullopt;
+            result_type result{ start_, last_, count_, states_.values() };
+            states_.reset();
+            count_ = 0;
+            return result;
+        }
+
+    private:
+        time_type gap_;
+        time_type start_{};
+        time_type last_{};
+        std::uint64_t count_ = 0;
+        states_type states_;
+    };
+}
+
+#endif
@@ -1,10 +1,55 @@
 #include "testCopying.cpp"
+#include "testStatic.cpp"
+#include "named_tuple.h"
+#include "parser.h"
+#include "patch.h"
+#include "record_writer.h"
+#include "sketch.h"
+#include "soa.h"
+#include "type_set.h"
+#include "window.h"
+#include "bloom_filter.h"
+#include "column_filter.h"
+#include "columns.h"
+#include "concurrent_map.h"
+#include "external_sort.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "trace.h"
+#include "benchParser.cpp"
+#include "benchTuple.cpp"
+#include "benchMetrics.cpp"
+#include "benchTrace.cpp"
+#include "benchHistogram.cpp"
+#include "benchPatch.cpp"
+#include "benchConcurrentMap.cpp"
+#include "benchColumns.cpp"
+#include "benchColumnFilter.cpp"
+#include "benchSoa.cpp"
+#include "benchExternalSort.cpp"
+#include "benchWindow.cpp"
+#include "benchSketch.cpp"
+#include "benchBloomFilter.cpp"
+#include "benchRecordWriter.cpp"
+#include "testMinimalCopies.cpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string_view>
 #include <tuple>
+#include <unordered_map>
 
 using namespace metakit;
 using namespace test;
 
-int main()
+int main(int argc, char** argv)
 {
 	constexpr size_t metakit_tuple = 1;
 	constexpr size_t std_tuple = 2;
@@ -43,17 +88,929 @@ int main()
             ASSERT_EQ(c1, c2); ///< Validates that the copy/move characteristics match.
         });
         
-    testing::TesterWithBuilder<1>::test("tuple_cat",[]()
+    testing::TesterWithBuilder<1>::test("tuple_cat",[](auto)
         {
             auto c1 = make_copy_counter<metakit_tuple>(); ///< Creates a copy counter for metakit_tuple.
             auto c2 = make_copy_counter<std_tuple>(); ///< Creates a copy counter for std_tuple.
 
-            tuple t1 = tuple_cat(tuple{ 3,c1,4 }, tuple{ 3.5,c1,"hassan" });
-            std::tuple t2 = std::tuple_cat(std::tuple{ 3,c2,4 }, std::tuple{ 3.5,c2,"hassan" });
+            [[maybe_unused]] tuple t1 = tuple_cat(tuple{ 3,c1,4 }, tuple{ 3.5,c1,"hassan" });
+            [[maybe_unused]] std::tuple t2 = std::tuple_cat(std::tuple{ 3,c2,4 }, std::tuple{ 3.5,c2,"hassan" });
 
             ASSERT_EQ(c1, c2);
         });
 
+    testing::Tester::test("named_tuple", []()
+        {
+            /**
+             * @brief Tests that named access aliases the same storage as positional access.
+             */
+            using record = named_tuple<field<"ts", unsigned long long>, field<"px", double>, field<"qty", int>>;
+
+            record r{ 42ull, 101.5, 7 };
+
+            ASSERT_EQ(get<"ts">(r), 42ull);
+            ASSERT_EQ(get<"px">(r), 101.5);
+            ASSERT_EQ(get<"qty">(r), 7);
+
+            get<"px">(r) = 99.25;
+            ASSERT_EQ(get<1>(r), 99.25);
+            ASSERT(&get<"qty">(r) == &get<2>(r.as_tuple()));
+            ASSERT_EQ(record::names[2], "qty");
+        });
+
+    testing::Tester::test("parser", []()
+        {
+            /**
+             * @brief Tests that sequence values are concatenated into a tuple with `unit` values dropped.
+             */
+            constexpr auto quote = seq(lit("px="), int_<>, skip(many(lit(" "))), lit("qty="), int_<unsigned>);
+
+            auto q = parse(quote, "px=-42   qty=7");
+            ASSERT(q.has_value());
+            ASSERT_EQ(get<0>(*q), -42);
+            ASSERT_EQ(get<1>(*q), 7u);
+            ASSERT(!parse(quote, "px=-42 qty=").has_value());
+
+            constexpr auto list = seq(int_<>, many(seq(lit(","), int_<>)));
+            auto values = parse(list, "1,2,3");
+            ASSERT(values.has_value());
+            ASSERT_EQ(get<0>(*values), 1);
+            ASSERT_EQ(get<1>(*values).size(), 2u);
+
+            constexpr auto message = alt(seq(lit("NEW "), int_<>), seq(lit("CXL "), int_<>, lit(" "), int_<>));
+            auto cancel = parse(message, "CXL 5 6");
+            ASSERT(cancel.has_value());
+            ASSERT_EQ(cancel->index(), 1u);
+            ASSERT_EQ(get<1>(std::get<1>(*cancel)), 6);
+        });
+
+    testing::Tester::test("type_set", []()
+        {
+            /**
+             * @brief Tests set algebra and enumeration on a set built at run time.
+             */
+            struct position {};
+            struct velocity {};
+            struct health {};
+            struct sprite {};
+            using components = type_set<type_list<position, velocity, health, sprite>>;
+
+            components entity;
+            entity.insert<position>();
+            entity.insert(components::index_of<sprite>());
+
+            const auto movable = components::of<position, velocity>();
+            ASSERT(!entity.includes(movable));
+            entity |= movable;
+            ASSERT(entity.includes(movable));
+            ASSERT_EQ(entity.size(), 3u);
+            ASSERT((entity - movable) == components::of<sprite>());
+
+            size_t visited = 0;
+            entity.for_each([&]<typename T>(has_type<T>)
+            {
+                ASSERT(!(is_same_v<T, health>));
+                ++visited;
+            });
+            ASSERT_EQ(visited, 3u);
+        });
+
+    testing::Tester::test("column_filter", []()
+        {
+            /**
+             * @brief Tests every predicate against a scalar reference on SIMD and scalar column types, then late materialization.
+             */
+            const auto check = [](const auto& column, const auto& predicate)
+            {
+                std::vector<std::uint64_t> bitmap(bitmap_words(column.size()) + 1, ~0ull);
+                std::vector<std::uint32_t> selection(column.size());
+                const size_t selected = filter_bitmap(std::span(column), predicate, std::span(bitmap));
+                ASSERT_EQ(filter_selection(std::span(column), predicate, std::span(selection)), selected);
+                std::vector<std::uint32_t> from_bitmap(selected);
+                ASSERT_EQ(bitmap_to_selection(std::span(bitmap).first(bitmap_words(column.size())), from_bitmap), selected);
+
+                size_t expected = 0;
+                for (size_t i = 0; i < column.size(); ++i)
+                {
+                    const bool hit = predicate(column[i]);
+                    ASSERT_EQ(((bitmap[i / 64] >> (i % 64)) & 1) != 0, hit);
+                    if (hit)
+                    {
+                        ASSERT_EQ(selection[expected], std::uint32_t(i));
+                        ASSERT_EQ(from_bitmap[expected], std::uint32_t(i));
+                        ++expected;
+                    }
+                }
+                ASSERT_EQ(expected, selected);
+                if (column.size() % 64 != 0)
+                    ASSERT_EQ(bitmap[column.size() / 64] >> (column.size() % 64), 0ull);
+            };
+
+            const auto check_all = [&]<typename T>(const std::vector<T>& column, T a, T b)
+            {
+                for (const auto op : { compare::less, compare::less_equal, compare::greater, compare::greater_equal, compare::equal, compare::not_equal })
+                    check(column, compare_to<T>{ op, a });
+                check(column, in_range<T>{ a, b });
+                check(column, in_range<T>{ b, a });
+                std::vector<T> small = { T(1), a, b };
+                std::sort(small.begin(), small.end());
+                const std::vector<T> large = { T(1), T(2), T(3), T(5), T(8), T(13), T(21), T(34), T(55), T(89), T(100), T(110), T(120), T(130), T(140), T(150), T(160) };
+                check(column, in_set<T>{ small });
+                check(column, in_set<T>{ large });
+            };
+
+            for (const size_t n : { 0, 3, 64, 1001 })
+            {
+                std::vector<float> floats;
+                std::vector<double> doubles;
+                std::vector<std::int32_t> ints;
+                std::vector<std::uint32_t> uints;
+                std::vector<std::int64_t> longs;
+                std::vector<std::int16_t> shorts;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const int v = int((i * 37) % 200) - 50;
+                    floats.push_back(i % 97 == 5 ? std::numeric_limits<float>::quiet_NaN() : float(v));
+                    doubles.push_back(double(v) / 2);
+                    ints.push_back(v);
+                    uints.push_back(v < 0 ? 0xFFFFFF00u + std::uint32_t(v) : std::uint32_t(v));
+                    longs.push_back(v);
+                    shorts.push_back(std::int16_t(v));
+                }
+                check_all(floats, 13.0f, 100.0f);
+                check_all(doubles, 13.0, 50.0);
+                check_all(ints, -10, 100);
+                check_all(uints, 13u, 0xFFFFFFF0u);
+                check_all(longs, std::int64_t(-10), std::int64_t(100));
+                check_all(shorts, std::int16_t(13), std::int16_t(120));
+            }
+
+            std::vector<std::uint32_t> ids;
+            std::vector<float> prices;
+            for (std::uint32_t i = 0; i < 500; ++i)
+            {
+                ids.push_back(i);
+                prices.push_back(float(i % 50));
+            }
+            std::vector<std::uint32_t> selection(ids.size());
+            size_t n = filter_selection(std::span<const float>(prices), compare_to<float>{ compare::less, 5.0f }, std::span(selection));
+            ASSERT_EQ(n, 50u);
+            n = refine_selection(std::span<const std::uint32_t>(ids), in_range<std::uint32_t>{ 100, 299 }, std::span(selection).first(n));
+            ASSERT_EQ(n, 20u);
+
+            std::vector<std::uint64_t> cheap(bitmap_words(prices.size())), early(bitmap_words(ids.size()));
+            filter_bitmap(std::span<const float>(prices), compare_to<float>{ compare::less, 5.0f }, std::span(cheap));
+            filter_bitmap(std::span<const std::uint32_t>(ids), in_range<std::uint32_t>{ 100, 299 }, std::span(early));
+            bitmap_and(cheap, early);
+            std::vector<std::uint32_t> from_bitmap(ids.size());
+            ASSERT_EQ(bitmap_to_selection(cheap, from_bitmap), 20u);
+            ASSERT(std::equal(selection.begin(), selection.begin() + 20, from_bitmap.begin()));
+
+            std::vector<tuple<std::uint32_t, float>> rows;
+            materialize(std::span<const std::uint32_t>(selection).first(n), rows, ids, prices);
+            ASSERT_EQ(rows.size(), 20u);
+            for (const auto& row : rows)
+                ASSERT(get<0>(row) >= 100 && get<0>(row) < 300 && get<1>(row) < 5.0f && get<1>(row) == float(get<0>(row) % 50));
+        });
+
+    testing::Tester::test("columns", []()
+        {
+            /**
+             * @brief Tests that scatter and gather round-trip for the shuffled and the blocked kernels, including tails.
+             */
+            const auto round_trip = []<typename... Ts>(size_t n, has_type<tuple<Ts...>>)
+            {
+                // Every element of a row differs, so that a permutation of the lanes fails the comparisons.
+                std::vector<tuple<Ts...>> rows;
+                [&]<size_t... indices>(index_sequence<indices...>)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                        rows.push_back(tuple<Ts...>{ Ts(i * sizeof...(Ts) + indices)... });
+                }(make_index_sequence<sizeof...(Ts)>{});
+
+                std::tuple<std::vector<Ts>...> columns{ std::vector<Ts>(n)... };
+                std::apply([&](auto&... c) { scatter_to_columns(rows, c...); }, columns);
+                [&]<size_t... indices>(index_sequence<indices...>)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                        ASSERT(((std::get<indices>(columns)[i] == get<indices>(rows[i])) && ...));
+                }(make_index_sequence<sizeof...(Ts)>{});
+
+                std::vector<tuple<Ts...>> copies(n, tuple<Ts...>{ Ts()... });
+                std::apply([&](const auto&... c) { gather_from_columns(copies, c...); }, columns);
+                for (size_t i = 0; i < n; ++i)
+                    ASSERT(tuple_equal{}(copies[i], rows[i]));
+            };
+
+            for (const size_t n : { 0, 1, 7, 1003, 70000 })
+            {
+                round_trip(n, has_type<tuple<float, float, float, float>>{});
+                round_trip(n, has_type<tuple<float, float>>{});
+                round_trip(n, has_type<tuple<double, double>>{});
+                round_trip(n, has_type<tuple<std::int64_t, std::int64_t, std::int64_t, std::int64_t>>{});
+                round_trip(n, has_type<tuple<std::uint8_t, double, std::int16_t>>{});
+            }
+            round_trip(parallel_rows + 5, has_type<tuple<std::int32_t, std::int32_t, std::int32_t, std::int32_t>>{});
+        });
+
+    testing::Tester::test("soa", []()
+        {
+            /**
+             * @brief Tests that soa_of stores a plain struct field by field and that its proxies read and write the columns.
+             */
+            struct order
+            {
+                std::uint64_t id;
+                double price;
+                std::int32_t quantity;
+                std::string venue;
+            };
+            static_assert(aggregate_field_count_v<order> == 4);
+
+            soa_of<order> orders;
+            for (std::uint64_t i = 0; i < 100; ++i)
+                orders.push_back(order{ i, double(i) / 4, std::int32_t(i % 7), i % 2 ? "x" : "y" });
+            ASSERT_EQ(orders.size(), 100u);
+            ASSERT_EQ(orders.column<&order::price>().size(), 100u);
+            ASSERT_EQ(orders.column<1>().data(), orders.column<&order::price>().data());
+
+            double total = 0;
+            for (const double price : orders.column<&order::price>())
+                total += price;
+            ASSERT_EQ(total, 99.0 * 100 / 8);
+
+            orders[3].get<&order::quantity>() += 10;
+            ASSERT_EQ(orders.column<2>()[3], 13);
+            get<3>(orders[4].tie()) = "z";
+            ASSERT_EQ(orders.load(4).venue, std::string("z"));
+
+            orders[5] = order{ 500, 1.5, -1, "w" };
+            const order loaded = orders[5];
+            ASSERT(loaded.id == 500 && loaded.price == 1.5 && loaded.quantity == -1 && loaded.venue == "w");
+
+            const soa_of<order>& view = orders;
+            ASSERT_EQ(view[6].get<&order::id>(), 6u);
+            static_assert(std::is_const_v<std::remove_reference_t<decltype(view[6].get<0>())>>);
+            ASSERT_EQ(get<1>(view[8].tie()), 2.0);
+
+            orders.clear();
+            ASSERT(orders.empty());
+
+            // A field whose copy throws leaves the columns the same size.
+            struct fragile
+            {
+                int v = 0;
+                fragile() = default;
+                explicit fragile(int value) : v(value) {}
+                fragile(const fragile& other) : v(other.v) { if (v < 0) throw v; }
+                fragile& operator=(const fragile&) = default;
+            };
+            struct sample
+            {
+                std::uint32_t id;
+                fragile reading;
+                double weight;
+            };
+            soa_of<sample> samples;
+            samples.push_back(sample{ 1, fragile(5), 0.5 });
+            bool thrown = false;
+            try { samples.push_back(sample{ 2, fragile(-1), 1.5 }); }
+            catch (int) { thrown = true; }
+            ASSERT(thrown);
+            ASSERT(samples.size() == 1 && samples.column<0>().size() == 1 && samples.column<1>().size() == 1 && samples.column<2>().size() == 1);
+            samples.push_back(sample{ 3, fragile(7), 2.5 });
+            ASSERT(samples.load(1).id == 3 && samples.load(1).reading.v == 7 && samples.load(1).weight == 2.5);
+        });
+
+    testing::Tester::test("concurrent_map", []()
+        {
+            /**
+             * @brief Tests concurrent inserts, batched lookups and erasure, with and without optimistic reads.
+             */
+            using key = tuple<std::uint32_t, std::uint16_t>;
+            concurrent_map<key, std::uint64_t, 8> map;
+            static_assert(decltype(map)::optimistic_reads);
+
+            std::vector<std::thread> threads;
+            for (std::uint32_t t = 0; t < 4; ++t)
+                threads.emplace_back([&, t] {
+                    for (std::uint32_t i = t; i < 4000; i += 4)
+                        map.insert_or_assign(key{ i, std::uint16_t(i % 7) }, i * 10ull);
+                });
+            for (auto& thread : threads)
+                thread.join();
+            ASSERT_EQ(map.size(), 4000u);
+            ASSERT(!map.insert_or_assign(key{ 5u, std::uint16_t(5) }, 51ull));
+
+            std::vector<key> keys;
+            for (std::uint32_t i = 0; i < 5000; i += 2)
+                keys.push_back(key{ i, std::uint16_t(i % 7) });
+            std::vector<std::optional<std::uint64_t>> values(keys.size());
+            ASSERT_EQ(map.find_many(keys, values), 2000u);
+            for (size_t k = 0; k < keys.size(); ++k)
+                ASSERT(values[k] == (get<0>(keys[k]) < 4000 ? std::optional<std::uint64_t>(get<0>(keys[k]) * 10ull) : std::nullopt));
+            ASSERT(map.find(key{ 5u, std::uint16_t(5) }) == std::optional<std::uint64_t>(51));
+
+            for (std::uint32_t i = 0; i < 4000; i += 3)
+                ASSERT(map.erase(key{ i, std::uint16_t(i % 7) }));
+            ASSERT(!map.contains(key{ 3u, std::uint16_t(3) }) && map.contains(key{ 4u, std::uint16_t(4) }));
+
+            concurrent_map<tuple<std::string, int>, std::string, 4> names;
+            static_assert(!decltype(names)::optimistic_reads);
+            for (int i = 0; i < 100; ++i)
+                names.insert_or_assign(tuple<std::string, int>{ std::string("k"), i }, std::to_string(i));
+            ASSERT(names.find(tuple<std::string, int>{ std::string("k"), 42 }) == std::optional<std::string>("42"));
+            ASSERT(!names.find(tuple<std::string, int>{ std::string("x"), 42 }).has_value());
+
+            // Insert and erase churn purges erased slots in place: the tables do not grow.
+            concurrent_map<tuple<std::uint64_t, std::uint32_t>, std::uint64_t, 1> churn;
+            const size_t initial_bytes = churn.table_bytes();
+            for (std::uint64_t i = 0; i < 1200000; ++i)
+            {
+                churn.insert_or_assign(tuple<std::uint64_t, std::uint32_t>{ i, std::uint32_t(i) }, i);
+                ASSERT(churn.erase(tuple<std::uint64_t, std::uint32_t>{ i, std::uint32_t(i) }));
+            }
+            ASSERT_EQ(churn.size(), 0u);
+            ASSERT_EQ(churn.table_bytes(), initial_bytes);
+
+            // Tables retired by growth are freed once no reader can hold them.
+            std::atomic<bool> growing{ true };
+            std::thread reader([&] {
+                while (growing.load(std::memory_order_relaxed))
+                    (void)churn.find(tuple<std::uint64_t, std::uint32_t>{ 7ull, 7u });
+            });
+            for (std::uint64_t i = 0; i < 100000; ++i)
+                churn.insert_or_assign(tuple<std::uint64_t, std::uint32_t>{ i, std::uint32_t(i) }, i);
+            growing = false;
+            reader.join();
+            ASSERT(churn.insert_or_assign(tuple<std::uint64_t, std::uint32_t>{ 100000ull, 0u }, 0ull));
+            ASSERT(churn.find(tuple<std::uint64_t, std::uint32_t>{ 7ull, 7u }) == std::optional<std::uint64_t>(7));
+            const size_t slot_bytes = initial_bytes / 32; // an empty single-shard map has one table of 32 slots
+            ASSERT(churn.table_bytes() % slot_bytes == 0 && std::has_single_bit(churn.table_bytes() / slot_bytes));
+        });
+
+    testing::Tester::test("external_sort", []()
+        {
+            /**
+             * @brief Tests a stable multi-pass sort under a tiny budget against std::stable_sort, and the rejection of partial records.
+             */
+            using record = tuple<std::uint32_t, std::uint32_t, double>;
+            const std::filesystem::path directory = std::filesystem::temp_directory_path();
+            const std::filesystem::path input = directory / "metakit_sort_in.bin", output = directory / "metakit_sort_out.bin";
+
+            std::vector<record> records;
+            std::uint32_t x = 12345;
+            for (std::uint32_t i = 0; i < 100000; ++i)
+            {
+                x = x * 1103515245u + 12345u;
+                records.push_back(record{ (x >> 8) % 5000, i, double(x % 97) });
+            }
+            {
+                std::ofstream file(input, std::ios::binary);
+                file.write(reinterpret_cast<const char*>(records.data()), std::streamsize(records.size() * sizeof(record)));
+            }
+
+            external_sort_options options;
+            options.memory_budget = 64 * 1024;
+            options.io_buffer = 4096;
+            options.threads = 3;
+            const auto stats = external_sort<record, 2, 0>(input, output, options);
+            ASSERT(stats.has_value());
+            ASSERT_EQ(stats->records, records.size());
+            ASSERT(stats->runs > 15 && stats->merge_passes == 2);
+            ASSERT(stats->peak_buffer_bytes <= options.memory_budget);
+            // Each thread's share holds a chunk and half a chunk of sort scratch.
+            const size_t chunk_records = options.memory_budget / options.threads / sizeof(record) * 2 / 3;
+            ASSERT_EQ(stats->runs, (records.size() + chunk_records - 1) / chunk_records);
+
+            std::stable_sort(records.begin(), records.end(), key_less<2, 0>{});
+            std::vector<char> sorted(records.size() * sizeof(record));
+            {
+                std::ifstream file(output, std::ios::binary);
+                file.read(sorted.data(), std::streamsize(sorted.size()));
+                ASSERT(file.gcount() == std::streamsize(sorted.size()) && file.peek() == EOF);
+            }
+            ASSERT(std::memcmp(sorted.data(), records.data(), sorted.size()) == 0);
+
+            // A budget smaller than one I/O buffer merges two runs at a time.
+            options.io_buffer = 128 * 1024;
+            const auto pairwise = external_sort<record, 2, 0>(input, output, options);
+            ASSERT(pairwise.has_value());
+            ASSERT(pairwise->merge_passes == size_t(std::bit_width(pairwise->runs - 1)));
+            options.io_buffer = 4096;
+            for (const auto& entry : std::filesystem::directory_iterator(directory))
+                ASSERT(entry.path().filename().string().find("metakit_sort_out.bin.run") == std::string::npos);
+
+            {
+                std::ofstream file(input, std::ios::binary | std::ios::app);
+                file.put('x');
+            }
+            ASSERT(!(external_sort<record, 0>(input, output, options).has_value()));
+
+            // An empty input has no run, and sorts into an empty output.
+            std::ofstream(input, std::ios::binary | std::ios::trunc).close();
+            const auto empty = external_sort<record, 0>(input, output, options);
+            ASSERT(empty.has_value());
+            ASSERT(empty->records == 0 && empty->runs == 0);
+            ASSERT(std::filesystem::exists(output) && std::filesystem::file_size(output) == 0);
+            std::filesystem::remove(input);
+            std::filesystem::remove(output);
+        });
+
+    testing::Tester::test("window", []()
+        {
+            /**
+             * @brief Tests sliding, tumbling and session windows against aggregates recomputed from scratch.
+             */
+            using event = tuple<std::int64_t, std::int32_t>;
+            using aggregators = type_list<aggregate::sum<1>, aggregate::min<1>, aggregate::max<1>, aggregate::count, aggregate::mean<1>>;
+
+            std::vector<event> events;
+            std::uint32_t x = 7;
+            std::int64_t now = 0;
+            for (int i = 0; i < 3000; ++i)
+            {
+                x = x * 1103515245u + 12345u;
+                now += (x >> 16) % 4 == 0 ? std::int64_t((x >> 8) % 40) : 0;
+                events.push_back(event{ now, std::int32_t((x >> 4) % 1000) - 500 });
+            }
+
+            const auto recompute = [&](size_t begin, size_t end)
+            {
+                std::int64_t total = 0;
+                std::int32_t low = get<1>(events[begin]), high = low;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    total += get<1>(events[i]);
+                    low = std::min(low, get<1>(events[i]));
+                    high = std::max(high, get<1>(events[i]));
+                }
+                return std::make_tuple(total, low, high, std::uint64_t(end - begin));
+            };
+            const auto check = [&](const auto& values, size_t begin, size_t end)
+            {
+                const auto [total, low, high, n] = recompute(begin, end);
+                ASSERT_EQ(get<0>(values), total);
+                ASSERT_EQ(get<1>(values), low);
+                ASSERT_EQ(get<2>(values), high);
+                ASSERT_EQ(get<3>(values), n);
+                ASSERT(std::abs(get<4>(values) - double(total) / double(n)) < 1e-9);
+            };
+
+            sliding_window<event, 0, aggregators> sliding(100);
+            size_t first = 0;
+            for (size_t i = 0; i < events.size(); ++i)
+            {
+                const auto values = sliding.push(events[i]);
+                while (get<0>(events[first]) + 100 <= get<0>(events[i]))
+                    ++first;
+                ASSERT_EQ(sliding.size(), i + 1 - first);
+                check(values, first, i + 1);
+            }
+
+            tumbling_window<event, 0, aggregators> tumbling(250);
+            size_t begin = 0, windows = 0;
+            const auto check_tumbling = [&](const auto& result, size_t end)
+            {
+                ASSERT_EQ(result.start, get<0>(events[begin]) / 250 * 250);
+                ASSERT_EQ(result.end, result.start + 250);
+                ASSERT(get<0>(events[end - 1]) < result.end);
+                ASSERT_EQ(result.records, end - begin);
+                check(result.values, begin, end);
+                begin = end;
+                ++windows;
+            };
+            for (size_t i = 0; i < events.size(); ++i)
+                if (const auto result = tumbling.push(events[i]))
+                    check_tumbling(*result, i);
+            check_tumbling(*tumbling.flush(), events.size());
+            ASSERT(!tumbling.flush().has_value());
+            ASSERT(windows > 10);
+
+            session_window<event, 0, aggregators> sessions(30);
+            begin = 0;
+            size_t session_count = 0;
+            for (size_t i = 0; i < events.size(); ++i)
+                if (const auto result = sessions.push(events[i]))
+                {
+                    ASSERT(get<0>(events[i]) - get<0>(events[i - 1]) > 30);
+                    ASSERT(result->start == get<0>(events[begin]) && result->end == get<0>(events[i - 1]));
+                    check(result->values, begin, i);
+                    begin = i;
+                    ++session_count;
+                }
+            ASSERT(session_count > 3);
+            check(sessions.flush()->values, begin, events.size());
+        });
+
+    testing::Tester::test("sketch", []()
+        {
+            /**
+             * @brief Tests the sketches against exact answers within their error bounds, and their per-thread merges.
+             */
+            using key = tuple<std::uint32_t, std::uint16_t>;
+            std::vector<key> keys;
+            for (std::uint32_t i = 0; i < 200000; ++i)
+                keys.push_back(key{ i % 50000, std::uint16_t(i % 3) }); // 150000 distinct keys
+            std::unordered_map<key, std::uint64_t, tuple_hash, tuple_equal> exact;
+            for (const key& k : keys)
+                ++exact[k];
+
+            hyperloglog<14> distinct;
+            distinct.add_many(std::span<const key>(keys));
+            ASSERT(std::abs(distinct.estimate() / double(exact.size()) - 1) < 3 * 1.04 / 128);
+            hyperloglog<14> few;
+            for (std::uint32_t i = 0; i < 100; ++i)
+                few.add(key{ i, std::uint16_t(0) });
+            ASSERT(std::abs(few.estimate() - 100) < 3);
+
+            count_min<4096, 4> frequencies;
+            frequencies.add_many(std::span<const key>(keys));
+            ASSERT_EQ(frequencies.total_count(), keys.size());
+            size_t beyond_bound = 0;
+            for (const auto& [k, n] : exact)
+            {
+                const std::uint64_t estimate = frequencies.estimate(k);
+                ASSERT(estimate >= n);
+                beyond_bound += double(estimate - n) > 2.72 / 4096 * double(keys.size());
+            }
+            ASSERT(double(beyond_bound) < 0.05 * double(exact.size()));
+
+            kll_sketch<double> quantiles;
+            std::vector<double> values;
+            std::uint64_t x = 88172645463325252ull;
+            for (int i = 0; i < 100000; ++i)
+            {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                values.push_back(double(x % 1000000));
+            }
+            quantiles.add_many(std::span<const double>(values));
+            std::sort(values.begin(), values.end());
+            ASSERT_EQ(quantiles.count(), values.size());
+            ASSERT(quantiles.retained() < 2000);
+            for (const double q : { 0.01, 0.1, 0.5, 0.9, 0.99 })
+            {
+                const double estimate = quantiles.quantile(q);
+                const double true_rank = double(std::upper_bound(values.begin(), values.end(), estimate) - values.begin()) / double(values.size());
+                ASSERT(std::abs(true_rank - q) < 0.02);
+                ASSERT(std::abs(quantiles.rank(estimate) - true_rank) < 0.02);
+            }
+
+            thread_sketches<hyperloglog<12>> per_thread_distinct;
+            thread_sketches<count_min<1024, 3>> per_thread_counts;
+            std::vector<std::thread> threads;
+            for (std::uint32_t t = 0; t < 4; ++t)
+                threads.emplace_back([&, t] {
+                    for (std::uint32_t i = t; i < 40000; i += 4)
+                    {
+                        per_thread_distinct.local().add(key{ i, std::uint16_t(7) });
+                        per_thread_counts.local().add(key{ i % 10, std::uint16_t(7) });
+                    }
+                });
+            for (auto& thread : threads)
+                thread.join();
+            ASSERT(std::abs(per_thread_distinct.merged().estimate() / 40000 - 1) < 3 * 1.04 / 64);
+            const auto counts = per_thread_counts.merged();
+            ASSERT_EQ(counts.total_count(), 40000u);
+            ASSERT(counts.estimate(key{ 3u, std::uint16_t(7) }) >= 4000u && counts.estimate(key{ 3u, std::uint16_t(7) }) < 4100u);
+
+            // A thread that alternates between sets finds its own sketch in each, and short-lived sets leave nothing behind.
+            thread_sketches<count_min<64, 2>> left, right;
+            for (std::uint32_t i = 0; i < 1000; ++i)
+            {
+                left.local().add(key{ i, std::uint16_t(0) });
+                right.local().add(key{ i, std::uint16_t(1) }, 2);
+            }
+            ASSERT(&left.local() != &right.local());
+            ASSERT_EQ(left.merged().total_count(), 1000u);
+            ASSERT_EQ(right.merged().total_count(), 2000u);
+            for (std::uint32_t query = 0; query < 10000; ++query)
+            {
+                thread_sketches<count_min<64, 2>> per_query;
+                per_query.local().add(key{ query, std::uint16_t(0) });
+                ASSERT_EQ(per_query.merged().total_count(), 1u);
+            }
+        });
+
+    testing::Tester::test("bloom_filter", []()
+        {
+            /**
+             * @brief Tests that a Bloom filter has no false negatives, a false positive rate near its sizing, and merges.
+             */
+            using key = tuple<std::uint32_t, std::uint16_t>;
+            std::vector<key> present, absent;
+            for (std::uint32_t i = 0; i < 100000; ++i)
+            {
+                present.push_back(key{ i, std::uint16_t(1) });
+                absent.push_back(key{ i, std::uint16_t(2) });
+            }
+
+            bloom_filter filter(present.size(), 10);
+            ASSERT_EQ(filter.bytes() % bloom_filter::block_bytes, 0u);
+            filter.insert_many(std::span<const key>(present));
+            for (const key& k : present)
+                ASSERT(filter.contains(k));
+            const auto found = std::make_unique<bool[]>(absent.size());
+            const std::span<bool> found_flags(found.get(), absent.size());
+            const size_t false_positives = filter.contains_many(std::span<const key>(absent), found_flags);
+            size_t one_by_one = 0;
+            for (size_t i = 0; i < absent.size(); ++i)
+            {
+                ASSERT_EQ(found_flags[i], filter.contains(absent[i]));
+                one_by_one += filter.contains(absent[i]);
+            }
+            ASSERT_EQ(false_positives, one_by_one);
+            ASSERT(double(false_positives) / double(absent.size()) < 0.02);
+            ASSERT_EQ(filter.contains_many(std::span<const key>(present), found_flags), present.size());
+
+            bloom_filter evens(present.size(), 10), odds(present.size(), 10);
+            for (size_t i = 0; i < present.size(); ++i)
+                (i % 2 == 0 ? evens : odds).insert(present[i]);
+            evens.merge(odds);
+            for (const key& k : present)
+                ASSERT(evens.contains(k));
+            evens.clear();
+            ASSERT(!evens.contains(present[0]));
+        });
+
+    testing::Tester::test("record_writer", []()
+        {
+            /**
+             * @brief Tests that records pushed from several threads are all written, each thread's in order, buffered and direct.
+             */
+            using record = tuple<std::uint32_t, std::uint32_t, std::uint16_t>; // thread, sequence, check
+            const std::filesystem::path path = std::filesystem::temp_directory_path() / "metakit_record_log.bin";
+            constexpr std::uint32_t n_threads = 4, per_thread = 30001;
+            for (const bool direct : { false, true })
+            {
+                async_record_writer<record> writer(path, record_writer_options{ 64 << 10, 2, direct, sync_policy::every_batch });
+                ASSERT(writer.is_open());
+                std::vector<std::thread> threads;
+                for (std::uint32_t t = 0; t < n_threads; ++t)
+                    threads.emplace_back([&, t] {
+                        std::vector<record> batch;
+                        for (std::uint32_t i = 0; i < per_thread; ++i)
+                        {
+                            const record r{ t, i, std::uint16_t(t * 7 + i) };
+                            if (t % 2 == 0)
+                                writer.push(r);
+                            else if (batch.push_back(r); batch.size() == 1000 || i + 1 == per_thread)
+                            {
+                                writer.push_many(std::span<const record>(batch));
+                                batch.clear();
+                            }
+                        }
+                    });
+                for (auto& thread : threads)
+                    thread.join();
+                ASSERT(writer.flush());
+                const record_writer_stats flushed = writer.stats();
+                ASSERT_EQ(std::filesystem::file_size(path), flushed.bytes_written);
+                ASSERT(flushed.records * sizeof(record) - flushed.bytes_written < (writer.direct() ? 4096u : 1u));
+                ASSERT(writer.close());
+                const record_writer_stats stats = writer.stats();
+                ASSERT_EQ(stats.records, std::uint64_t(n_threads) * per_thread);
+                ASSERT_EQ(stats.bytes_written, stats.records * sizeof(record));
+                ASSERT(stats.syncs >= stats.writes);
+
+                ASSERT_EQ(std::filesystem::file_size(path), stats.bytes_written);
+                std::vector<record> written(stats.records, record{ 0u, 0u, std::uint16_t(0) });
+                std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(written.data()), std::streamsize(stats.bytes_written));
+                std::vector<std::uint32_t> next(n_threads, 0);
+                for (const record& r : written)
+                {
+                    ASSERT(get<0>(r) < n_threads);
+                    ASSERT_EQ(get<1>(r), next[get<0>(r)]++);
+                    ASSERT_EQ(get<2>(r), std::uint16_t(get<0>(r) * 7 + get<1>(r)));
+                }
+            }
+            std::filesystem::remove(path);
+        });
+
+    testing::Tester::test("histogram", []()
+        {
+            /**
+             * @brief Tests that per-thread histograms merge and answer percentiles within their precision.
+             */
+            using layout = histogram_layout<1'000'000, 7>;
+            thread_histograms<layout> latencies;
+            std::vector<std::thread> threads;
+            for (std::uint64_t t = 0; t < 4; ++t)
+                threads.emplace_back([&, t] {
+                    for (std::uint64_t v = 1 + t; v <= 10000; v += 4)
+                        latencies.record(v);
+                });
+            for (auto& thread : threads)
+                thread.join();
+
+            const auto merged = latencies.merged();
+            ASSERT_EQ(merged.count(), 10000u);
+            for (double p : { 50.0, 90.0, 99.0, 99.9 })
+            {
+                const double exact = p * 100;
+                const double reported = double(merged.value_at_percentile(p));
+                ASSERT(reported >= exact && reported <= exact * (1 + 1.0 / 128));
+            }
+            ASSERT_EQ(merged.value_at_percentile(100), layout::highest_in(layout::index_of(10000)));
+
+            latencies.record(2'000'000);
+            ASSERT_EQ(latencies.merged().value_at_percentile(100), layout::highest_in(layout::bucket_count - 1));
+
+            // A long-lived thread may record into one set per request, next to a long-lived set.
+            for (std::uint64_t request = 1; request <= 1000; ++request)
+            {
+                thread_histograms<layout> per_request;
+                per_request.record(request);
+                latencies.record(request);
+                ASSERT_EQ(per_request.merged().count(), 1u);
+            }
+            ASSERT_EQ(latencies.merged().count(), 11001u);
+        });
+
+    testing::Tester::test("patch", []()
+        {
+            /**
+             * @brief Tests that a patch carries exactly the changed fields and rebuilds the record.
+             */
+            using quote = named_tuple<field<"ts", std::uint64_t>, field<"px", double>, field<"qty", int>, field<"side", char>>;
+            const quote before{ 1000ull, 0.0, 5, 'B' };
+            quote after = before;
+            get<"px">(after) = -0.0;
+            get<"qty">(after) = 7;
+
+            const auto changed = diff(before, after);
+            ASSERT(!changed.test(0) && changed.test(1) && changed.test(2) && !changed.test(3));
+            ASSERT_EQ(changed.count(), 2u);
+
+            std::array<std::byte, max_patch_size_v<quote>> buffer{};
+            const size_t size = serialize_patch(before, after, buffer);
+            ASSERT_EQ(size, 1 + sizeof(double) + sizeof(int));
+
+            quote replica = before;
+            ASSERT(apply_patch(replica, std::span<const std::byte>(buffer.data(), size)) == std::optional<size_t>(size));
+            ASSERT(!diff(replica, after).any());
+            ASSERT(std::signbit(get<"px">(replica)));
+
+            ASSERT(!apply_patch(replica, std::span<const std::byte>(buffer.data(), size - 1)).has_value());
+
+            std::array<std::byte, record_size_v<quote>> full{};
+            ASSERT_EQ(serialize(after, full), sizeof(std::uint64_t) + sizeof(double) + sizeof(int) + sizeof(char));
+
+            const double nan = std::numeric_limits<double>::quiet_NaN();
+            ASSERT(!diff(tuple<double>{ nan }, tuple<double>{ nan }).any());
+        });
+
+    testing::Tester::test("metrics", []()
+        {
+            /**
+             * @brief Tests that counts from several threads, live and exited, add up.
+             */
+            struct requests {};
+            struct errors {};
+            using counters = metrics<type_list<requests, errors>>;
+
+            counters::aggregator aggregator{ std::chrono::milliseconds(1) };
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t)
+                threads.emplace_back([] {
+                    for (int i = 0; i < 1000; ++i)
+                        counters::inc<requests>();
+                    counters::inc<errors>(5);
+                });
+            for (auto& thread : threads)
+                thread.join();
+            counters::inc<requests>();
+
+            const auto totals = counters::collect();
+            ASSERT_EQ(totals.get<requests>(), 4001u);
+            ASSERT_EQ(totals.get<errors>(), 20u);
+            while (aggregator.latest().get<requests>() != 4001u)
+                std::this_thread::yield();
+        });
+
+    testing::Tester::test("trace", []()
+        {
+            /**
+             * @brief Tests that events from several threads decode to the same values, in order per thread, and at the time they were emitted.
+             */
+            struct order_received { int id; double price; };
+            struct order_filled { int id; short venue; };
+            using orders = tracer<type_list<order_received, order_filled>>;
+
+            const auto steady_ns = [] {
+                return std::int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+            };
+            // The two groups of events lie far enough apart that a wrong tick rate shows in their times.
+            const std::int64_t received_from = steady_ns();
+            std::thread producer([] {
+                for (int i = 0; i < 100; ++i)
+                    orders::emit(order_received{ i, i * 0.5 });
+            });
+            producer.join();
+            const std::int64_t received_to = steady_ns();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const std::int64_t filled_from = steady_ns();
+            for (int i = 0; i < 50; ++i)
+                orders::emit(order_filled{ i, short(i % 3) });
+            const std::int64_t filled_to = steady_ns();
+
+            std::stringstream file;
+            orders::write_header(file);
+            orders::drain(file);
+
+            int received = 0, filled = 0;
+            std::map<std::uint32_t, std::uint64_t> last_ticks;
+            const auto summary = orders::decode(file, [&](const trace_event_info& info, const auto& event)
+                {
+                    ASSERT(info.ticks >= last_ticks[info.thread]);
+                    last_ticks[info.thread] = info.ticks;
+                    const std::int64_t tolerance = 1'000'000;
+                    if constexpr (is_same_v<remove_cvrf_t<decltype(event)>, order_received>)
+                    {
+                        ASSERT(event.id == received++ && event.price == event.id * 0.5);
+                        ASSERT(info.nanoseconds >= received_from - tolerance && info.nanoseconds <= received_to + tolerance);
+                    }
+                    else
+                    {
+                        ASSERT(event.id == filled++ && event.venue == event.id % 3);
+                        ASSERT(info.nanoseconds >= filled_from - tolerance && info.nanoseconds <= filled_to + tolerance);
+                    }
+                });
+            ASSERT(summary.has_value());
+            ASSERT_EQ(summary->events, 150u);
+            ASSERT_EQ(summary->dropped, 0u);
+            ASSERT_EQ(received, 100);
+            ASSERT_EQ(filled, 50);
+
+            std::stringstream foreign;
+            tracer<type_list<order_filled>>::write_header(foreign);
+            ASSERT(!orders::decode(foreign, [](const auto&, const auto&) {}).has_value());
+        });
+
+    minimal_copies::run_minimal_copy_tests();
+
+#ifdef METAKIT_AUDIT_COPIES
+    testing::Tester::test("audit_copies", []()
+        {
+            /**
+             * @brief Tests that element copies and moves are attributed to their call sites.
+             */
+            auto counts_at = [](const std::source_location& site)
+            {
+                for (const auto& entry : audit_report())
+                    if (entry.site.line() == site.line() && std::string_view{ entry.site.file_name() } == site.file_name())
+                        return std::pair{ entry.copies, entry.moves };
+                return std::pair<std::uint64_t, std::uint64_t>{ 0, 0 };
+            };
+
+            audit_reset();
+            const std::string name = "hassan";
+            const auto row = metakit::make_tuple(name, std::string("bassam"), 3);
+
+            const auto transformed = std::source_location::current();
+            [[maybe_unused]] auto&& upper = metakit::transform(row, [](const auto& e) { return e; }, transformed);
+            ASSERT(counts_at(transformed) == (std::pair<std::uint64_t, std::uint64_t>{ 0, 3 }));
+
+            const auto scoped = std::source_location::current();
+            {
+                audit_scope scope{ scoped };
+                [[maybe_unused]] auto&& copies = metakit::make_tuple(name, name);
+                [[maybe_unused]] auto&& cat = metakit::tuple_cat(copies, metakit::make_tuple(1));
+            }
+            ASSERT(counts_at(scoped) == (std::pair<std::uint64_t, std::uint64_t>{ 4, 2 }));
+
+            // The table of a finished thread is freed, and its counts are kept.
+            const auto threaded = std::source_location::current();
+            for (int i = 0; i < 3; ++i)
+                std::thread([&] {
+                    audit_scope scope{ threaded };
+                    [[maybe_unused]] auto&& copies = metakit::make_tuple(name);
+                }).join();
+            ASSERT(counts_at(threaded) == (std::pair<std::uint64_t, std::uint64_t>{ 3, 0 }));
+        });
+#endif
+
+    if (argc > 1 && std::string_view{ argv[1] } == "--bench")
+    {
+        testing::Benchmark::collect_counters = argc > 2 && std::string_view{ argv[2] } == "--perf";
+        bench::run_parser_benchmarks();
+        bench::run_tuple_access_benchmarks();
+        bench::run_tuple_layout_benchmarks();
+        bench::run_metrics_benchmarks();
+        bench::run_trace_benchmarks();
+        bench::run_histogram_benchmarks();
+        bench::run_patch_benchmarks();
+        bench::run_concurrent_map_benchmarks();
+        bench::run_columns_benchmarks();
+        bench::run_column_filter_benchmarks();
+        bench::run_soa_benchmarks();
+        bench::run_external_sort_benchmarks();
+        bench::run_window_benchmarks();
+        bench::run_sketch_benchmarks();
+        bench::run_bloom_filter_benchmarks();
+        bench::run_record_writer_benchmarks();
+    }
 
 	return 0;
 }
@@ -0,0 +1,87 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+#include "bloom_filter.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Measures the false positive rate of a Bloom filter holding 1M keys at several sizes against the
+	   rate of an unblocked filter, and lookups per second one by one and batched, in cache and out of it, and in an unordered_set. */
+	inline void run_bloom_filter_benchmarks() {
+		using key = metakit::tuple<std::uint64_t, std::uint32_t>;
+		constexpr size_t n_present = 1000000;
+		constexpr size_t n_absent = 10000000;
+		std::vector<key> present, absent;
+		present.reserve(n_present);
+		absent.reserve(n_absent);
+		std::uint64_t x = 88172645463325252ull;
+		for (size_t i = 0; i < n_present + n_absent; ++i) {
+			x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+			// Present and absent keys differ in the second element, so they never collide.
+			(i < n_present ? present : absent).push_back(key{ x, std::uint32_t(i < n_present) });
+		}
+		const auto found = std::make_unique<bool[]>(n_absent);
+		const std::span<bool> found_flags(found.get(), n_absent);
+
+		for (const size_t bits_per_key : { 8, 10, 12, 16 }) {
+			metakit::bloom_filter filter(n_present, bits_per_key);
+			filter.insert_many(std::span<const key>(present));
+			const size_t false_positives = filter.contains_many(std::span<const key>(absent), found_flags);
+			// An unblocked filter with the optimal number of hashes, k = bits * ln 2.
+			const double k = std::round(double(bits_per_key) * std::log(2.0));
+			const double standard = std::pow(1 - std::exp(-k / double(bits_per_key)), k);
+			std::cerr << "          = " << bits_per_key << " bits/key (" << filter.bytes() / 1024 << " KiB): false positives "
+				<< 100 * double(false_positives) / double(n_absent) << "% (unblocked filter: " << 100 * standard << "%)\n";
+		}
+
+		metakit::bloom_filter filter(n_present, 10);
+		const auto print_rate = [](double ns, size_t n) { std::cerr << "          = " << double(n) / ns * 1e3 << " M keys/s\n"; };
+		print_rate(testing::Benchmark::run("bloom_filter/insert (1M keys)", 1, [&]() {
+			for (const key& k : present) {
+				filter.insert(k);
+			}
+			}), n_present);
+		filter.clear();
+		print_rate(testing::Benchmark::run("bloom_filter/insert_many (1M keys)", 1, [&]() {
+			filter.insert_many(std::span<const key>(present));
+			}), n_present);
+
+		size_t hits = 0;
+		print_rate(testing::Benchmark::run("bloom_filter/contains (10M absent keys)", 1, [&]() {
+			for (const key& k : absent) {
+				hits += filter.contains(k);
+			}
+			}), n_absent);
+		print_rate(testing::Benchmark::run("bloom_filter/contains_many (10M absent keys)", 1, [&]() {
+			hits += filter.contains_many(std::span<const key>(absent), found_flags);
+			}), n_absent);
+
+		// Sized for 200M keys, 250 MB, so that nearly every probe misses the caches.
+		metakit::bloom_filter large(200000000, 10);
+		large.insert_many(std::span<const key>(present));
+		print_rate(testing::Benchmark::run("bloom_filter/contains, 250 MB filter (10M absent keys)", 1, [&]() {
+			for (const key& k : absent) {
+				hits += large.contains(k);
+			}
+			}), n_absent);
+		print_rate(testing::Benchmark::run("bloom_filter/contains_many, 250 MB filter (10M absent keys)", 1, [&]() {
+			hits += large.contains_many(std::span<const key>(absent), found_flags);
+			}), n_absent);
+
+		std::unordered_set<key, metakit::tuple_hash, metakit::tuple_equal> exact(present.begin(), present.end());
+		print_rate(testing::Benchmark::run("bloom_filter/unordered_set find (10M absent keys)", 1, [&]() {
+			for (const key& k : absent) {
+				hits += exact.find(k) != exact.end();
+			}
+			}), n_absent);
+		testing::do_not_optimize(hits);
+		std::cerr << "          = memory: bloom_filter " << filter.bytes() << " B, unordered_set ~"
+			<< exact.size() * (sizeof(key) + 16) + exact.bucket_count() * 8 << " B\n";
+	}
+}
@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "column_filter.h"
+#include "columns.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Filters 10M rows on one field at selectivities from 0.1% to 90%, branching per row over
+	   vector<tuple> against SIMD column filters, and with a second predicate refining the selection. */
+	inline void run_column_filter_benchmarks() {
+		constexpr size_t n_rows = 10000000;
+		using row = metakit::tuple<std::uint32_t, float, std::int32_t>;
+
+		std::vector<row> rows;
+		rows.reserve(n_rows);
+		std::uint64_t x = 88172645463325252ull;
+		for (std::uint32_t i = 0; i < n_rows; ++i) {
+			x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+			rows.push_back(row{ i, float(x % 1000000) / 1000000.0f, std::int32_t(x >> 40) % 100 });
+		}
+		std::vector<std::uint32_t> ids(n_rows);
+		std::vector<float> prices(n_rows);
+		std::vector<std::int32_t> quantities(n_rows);
+		metakit::scatter_to_columns(rows, ids, prices, quantities);
+
+		std::vector<row> out;
+		out.reserve(n_rows);
+		std::vector<std::uint32_t> selection(n_rows);
+		std::vector<std::uint64_t> bitmap(metakit::bitmap_words(n_rows));
+
+		for (const double selectivity : { 0.001, 0.01, 0.1, 0.5, 0.9 }) {
+			const float threshold = float(selectivity);
+			const std::string suffix = " (10M rows, " + std::to_string(selectivity * 100).substr(0, 4) + "% selected)";
+			const metakit::compare_to<float> cheap{ metakit::compare::less, threshold };
+
+			testing::Benchmark::run("column_filter/branch per row over vector<tuple>" + suffix, 3, [&]() {
+				out.clear();
+				for (const row& r : rows) {
+					if (metakit::get<1>(r) < threshold) {
+						out.push_back(r);
+					}
+				}
+				testing::do_not_optimize(out.data());
+				});
+			testing::Benchmark::run("column_filter/filter_bitmap" + suffix, 3, [&]() {
+				testing::do_not_optimize(metakit::filter_bitmap(std::span<const float>(prices), cheap, std::span(bitmap)));
+				});
+			testing::Benchmark::run("column_filter/filter_selection + materialize" + suffix, 3, [&]() {
+				out.clear();
+				const size_t n = metakit::filter_selection(std::span<const float>(prices), cheap, std::span(selection));
+				metakit::materialize(std::span<const std::uint32_t>(selection).first(n), out, ids, prices, quantities);
+				testing::do_not_optimize(out.data());
+				});
+
+			testing::Benchmark::run("column_filter/two fields, branch per row" + suffix, 3, [&]() {
+				out.clear();
+				for (const row& r : rows) {
+					if (metakit::get<1>(r) < threshold && metakit::get<2>(r) >= 10 && metakit::get<2>(r) <= 60) {
+						out.push_back(r);
+					}
+				}
+				testing::do_not_optimize(out.data());
+				});
+			testing::Benchmark::run("column_filter/two fields, filter + refine_selection + materialize" + suffix, 3, [&]() {
+				out.clear();
+				size_t n = metakit::filter_selection(std::span<const float>(prices), cheap, std::span(selection));
+				n = metakit::refine_selection(std::span<const std::int32_t>(quantities), metakit::in_range<std::int32_t>{ 10, 60 },
+					std::span(selection).first(n));
+				metakit::materialize(std::span<const std::uint32_t>(selection).first(n), out, ids, prices, quantities);
+				testing::do_not_optimize(out.data());
+				});
+		}
+	}
+} // namespace test::bench
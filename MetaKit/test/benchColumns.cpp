@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "columns.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Prints the bytes read plus written per second of one transposition. */
+	inline void print_bandwidth(double ns, size_t bytes) {
+		std::cerr << "          = " << 2.0 * double(bytes) / ns << " GB/s (read + write)\n";
+	}
+
+	/* @brief Scatters and gathers n_rows rows with the library and with a naive per-row loop,
+	   reporting the bandwidth of each. */
+	template <typename... Ts>
+	void run_columns_case(const std::string& name, size_t n_rows) {
+		using row = metakit::tuple<Ts...>;
+		std::vector<row> rows;
+		rows.reserve(n_rows);
+		for (size_t i = 0; i < n_rows; ++i) {
+			rows.push_back(row{ Ts(i)... });
+		}
+		std::tuple<std::vector<Ts>...> columns{ std::vector<Ts>(n_rows)... };
+		const size_t bytes = n_rows * (sizeof(Ts) + ...);
+
+		const double naive_scatter = testing::Benchmark::run("columns/" + name + " naive per-row scatter (10M rows)", 3, [&]() {
+			[&]<size_t... indices>(std::index_sequence<indices...>) {
+				for (size_t i = 0; i < n_rows; ++i) {
+					((std::get<indices>(columns)[i] = metakit::get<indices>(rows[i])), ...);
+				}
+			}(std::index_sequence_for<Ts...>{});
+			testing::do_not_optimize(std::get<0>(columns).data());
+			});
+		print_bandwidth(naive_scatter, bytes);
+
+		const double scatter = testing::Benchmark::run("columns/" + name + " scatter_to_columns (10M rows)", 3, [&]() {
+			std::apply([&](auto&... c) { metakit::scatter_to_columns(rows, c...); }, columns);
+			testing::do_not_optimize(std::get<0>(columns).data());
+			});
+		print_bandwidth(scatter, bytes);
+
+		const double naive_gather = testing::Benchmark::run("columns/" + name + " naive per-row gather (10M rows)", 3, [&]() {
+			[&]<size_t... indices>(std::index_sequence<indices...>) {
+				for (size_t i = 0; i < n_rows; ++i) {
+					((metakit::get<indices>(rows[i]) = std::get<indices>(columns)[i]), ...);
+				}
+			}(std::index_sequence_for<Ts...>{});
+			testing::do_not_optimize(rows.data());
+			});
+		print_bandwidth(naive_gather, bytes);
+
+		const double gather = testing::Benchmark::run("columns/" + name + " gather_from_columns (10M rows)", 3, [&]() {
+			std::apply([&](const auto&... c) { metakit::gather_from_columns(rows, c...); }, columns);
+			testing::do_not_optimize(rows.data());
+			});
+		print_bandwidth(gather, bytes);
+	}
+
+	/* @brief Transposes 10M rows of four floats (shuffled kernel), two doubles (shuffled kernel)
+	   and a mixed row (blocked kernel) between AoS and SoA. */
+	inline void run_columns_benchmarks() {
+		constexpr size_t n_rows = 10000000;
+		std::cerr << "columns: " << std::thread::hardware_concurrency() << " hardware threads\n";
+		run_columns_case<float, float, float, float>("float x4", n_rows);
+		run_columns_case<double, double>("double x2", n_rows);
+		run_columns_case<std::uint32_t, double, std::int16_t>("u32/double/i16", n_rows);
+	}
+} // namespace test::bench
@@ -0,0 +1,97 @@
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrent_map.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	using cache_key = metakit::tuple<std::uint64_t, std::uint32_t>;
+
+	/* @brief The single-mutex cache that the sharded map replaces. */
+	struct locked_cache {
+		std::mutex mutex;
+		std::unordered_map<cache_key, std::uint64_t, metakit::tuple_hash, metakit::tuple_equal> map;
+
+		std::optional<std::uint64_t> find(const cache_key& key) {
+			std::lock_guard lock(mutex);
+			const auto it = map.find(key);
+			return it == map.end() ? std::nullopt : std::optional<std::uint64_t>(it->second);
+		}
+
+		void insert_or_assign(const cache_key& key, std::uint64_t value) {
+			std::lock_guard lock(mutex);
+			map.insert_or_assign(key, value);
+		}
+	};
+
+	/* @brief Runs a mixed read/write workload over a prefilled cache on n_threads threads.
+	   @return The mean time per operation over all threads, in nanoseconds. */
+	template <typename CACHE>
+	double run_cache_workload(std::string_view name, CACHE& cache, size_t n_keys, size_t n_threads, unsigned read_percent) {
+		constexpr size_t n_ops = 400000; // in total, split over the threads
+		const std::string label = std::string(name) + " (" + std::to_string(n_threads) + " threads, "
+			+ std::to_string(read_percent) + "% reads)";
+		const double ns = testing::Benchmark::run(label, 1, [&]() {
+			testing::run_on_threads(n_threads, [&](size_t t) {
+				std::uint64_t x = 0x9E3779B97F4A7C15ull * (t + 1);
+				std::uint64_t sum = 0;
+				for (size_t i = 0; i < n_ops / n_threads; ++i) {
+					x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+					const std::uint64_t k = x % n_keys;
+					const cache_key key{ k, std::uint32_t(k) };
+					if (x % 100 < read_percent) {
+						sum += cache.find(key).value_or(0);
+					}
+					else {
+						cache.insert_or_assign(key, x);
+					}
+				}
+				testing::do_not_optimize(sum);
+				});
+			});
+		return ns / double(n_ops);
+	}
+
+	/* @brief Compares the sharded map against one mutex around std::unordered_map from 1 to 64 threads,
+	   at several read ratios, and batched against one-by-one lookups. */
+	inline void run_concurrent_map_benchmarks() {
+		constexpr size_t n_keys = 1 << 18;
+
+		metakit::concurrent_map<cache_key, std::uint64_t> sharded(n_keys);
+		locked_cache locked;
+		for (std::uint64_t k = 0; k < n_keys; ++k) {
+			sharded.insert_or_assign(cache_key{ k, std::uint32_t(k) }, k);
+			locked.insert_or_assign(cache_key{ k, std::uint32_t(k) }, k);
+		}
+
+		for (const unsigned read_percent : { 100u, 90u, 50u }) {
+			for (const size_t n_threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+				const double sharded_ns = run_cache_workload("concurrent_map/sharded", sharded, n_keys, n_threads, read_percent);
+				const double locked_ns = run_cache_workload("concurrent_map/one mutex", locked, n_keys, n_threads, read_percent);
+				std::cerr << "          = " << 1000.0 / sharded_ns << " vs " << 1000.0 / locked_ns << " Mops/s\n";
+			}
+		}
+
+		std::vector<cache_key> keys;
+		for (std::uint64_t i = 0; i < 4096; ++i) {
+			const std::uint64_t k = (i * 0x9E3779B97F4A7C15ull) % n_keys;
+			keys.push_back(cache_key{ k, std::uint32_t(k) });
+		}
+		std::vector<std::optional<std::uint64_t>> values(keys.size());
+		testing::Benchmark::run("concurrent_map/find one by one (4096 keys)", 100, [&]() {
+			for (size_t i = 0; i < keys.size(); ++i) {
+				values[i] = sharded.find(keys[i]);
+			}
+			testing::do_not_optimize(values.data());
+			});
+		testing::Benchmark::run("concurrent_map/find_many (4096 keys)", 100, [&]() {
+			testing::do_not_optimize(sharded.find_many(keys, values));
+			});
+	}
+} // namespace test::bench
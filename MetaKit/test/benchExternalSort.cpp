@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "external_sort.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Sorts a 1 GiB file of 32-byte records under a 128 MiB budget, reporting throughput per
+	   phase and the buffer memory against the budget. The same code sorts files of any size; the
+	   file is kept small enough for a benchmark run. */
+	inline void run_external_sort_benchmarks() {
+		using record = metakit::tuple<std::uint64_t, std::uint64_t, std::uint64_t, std::uint64_t>;
+		constexpr size_t n_records = (size_t(1) << 30) / sizeof(record);
+		const std::filesystem::path directory = std::filesystem::temp_directory_path();
+		const std::filesystem::path input = directory / "metakit_sort_bench_in.bin";
+		const std::filesystem::path output = directory / "metakit_sort_bench_out.bin";
+
+		{
+			std::ofstream file(input, std::ios::binary);
+			std::vector<record> block;
+			block.reserve(1 << 16);
+			std::uint64_t x = 88172645463325252ull;
+			for (size_t i = 0; i < n_records; i += block.size()) {
+				block.clear();
+				for (size_t j = 0; j < (size_t(1) << 16) && i + j < n_records; ++j) {
+					x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+					block.push_back(record{ x, std::uint64_t(i + j), x >> 7, x >> 13 });
+				}
+				file.write(reinterpret_cast<const char*>(block.data()), std::streamsize(block.size() * sizeof(record)));
+			}
+		}
+
+		metakit::external_sort_options options;
+		options.memory_budget = size_t(128) << 20;
+		std::optional<metakit::external_sort_stats> stats;
+		const double ns = testing::Benchmark::run("external_sort/1 GiB of 32-byte records, 128 MiB budget", 1, [&]() {
+			stats = metakit::external_sort<record, 0>(input, output, options);
+			});
+		if (stats) {
+			const double mib = double(n_records * sizeof(record)) / double(1 << 20);
+			std::cerr << "          = " << mib / (ns / 1e9) << " MiB/s overall, runs " << mib / stats->run_seconds
+				<< " MiB/s (" << stats->runs << " runs), merge " << mib / stats->merge_seconds << " MiB/s ("
+				<< stats->merge_passes << " passes)\n"
+				<< "          = peak buffers " << double(stats->peak_buffer_bytes) / double(1 << 20) << " MiB of a "
+				<< double(options.memory_budget) / double(1 << 20) << " MiB budget\n";
+		}
+		else {
+			std::cerr << "          = external_sort failed\n";
+		}
+		std::filesystem::remove(input);
+		std::filesystem::remove(output);
+	}
+} // namespace test::bench
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <latch>
+#include <thread>
+#include <vector>
+
+#include "histogram.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Compares recording a latency into a histogram against keeping every sample for sorting,
+	   and reports the merge of 64 per-thread histograms through the latency output of the framework. */
+	inline void run_histogram_benchmarks() {
+		using layout = metakit::histogram_layout<1'000'000'000, 7>;
+		constexpr size_t n_values = 1000000;
+
+		std::vector<std::uint64_t> values(n_values);
+		std::uint64_t x = 88172645463325252ull;
+		for (auto& v : values) {
+			x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+			v = (x % 1000) * (1 + (x >> 60)) + 200; // mostly sub-microsecond, with a tail
+		}
+
+		metakit::histogram<layout> single;
+		testing::Benchmark::run("histogram/record, single-thread histogram (1M values)", 10, [&]() {
+			for (const auto v : values) {
+				single.record(v);
+			}
+			});
+
+		metakit::thread_histograms<layout> per_thread;
+		const double per_thread_ns = testing::Benchmark::run("histogram/record, thread_histograms (1M values)", 10, [&]() {
+			for (const auto v : values) {
+				per_thread.record(v);
+			}
+			});
+		std::cerr << "          = " << per_thread_ns / double(n_values) << " ns per record\n";
+
+		std::vector<std::uint64_t> samples;
+		samples.reserve(n_values);
+		testing::Benchmark::run("histogram/baseline: keep samples, sort for p99 (1M values)", 10, [&]() {
+			samples.clear();
+			for (const auto v : values) {
+				samples.push_back(v);
+			}
+			std::nth_element(samples.begin(), samples.begin() + samples.size() * 99 / 100, samples.end());
+			testing::do_not_optimize(samples[samples.size() * 99 / 100]);
+			});
+
+		std::cerr << "          p99 from histogram " << per_thread.merged().value_at_percentile(99)
+			<< ", exact " << samples[samples.size() * 99 / 100] << "\n";
+
+		// Keep 64 recording threads attached, then time the merge of all their histograms.
+		metakit::thread_histograms<layout> shared;
+		std::latch recorded{ 64 };
+		std::atomic<bool> done{ false };
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < 64; ++t) {
+			threads.emplace_back([&, t]() {
+				for (size_t i = t; i < n_values; i += 64) {
+					shared.record(values[i]);
+				}
+				recorded.count_down();
+				while (!done.load()) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				});
+		}
+		recorded.wait();
+		testing::Benchmark::run_with_latencies("histogram/merge of 64 thread histograms", 1000, [&]() {
+			testing::do_not_optimize(shared.merged());
+			});
+		done = true;
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+} // namespace test::bench
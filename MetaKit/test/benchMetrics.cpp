@@ -0,0 +1,92 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "metrics.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	struct requests {};
+	struct cache_hits {};
+	struct cache_misses {};
+	struct bytes_sent {};
+	using service_metrics = metakit::metrics<metakit::type_list<requests, cache_hits, cache_misses, bytes_sent>>;
+
+	/* @brief Compares tag-slot counters against a string-keyed map of atomics at 64 threads,
+	   and measures what a background aggregator costs the incrementing threads. */
+	inline void run_metrics_benchmarks() {
+		constexpr size_t n_threads = 64;
+		constexpr size_t n_incs = 100000; // per thread, spread over 4 counters
+
+		auto report_per_inc = [&](double ns_per_iteration) {
+			std::cerr << "          = " << ns_per_iteration / double(n_threads * n_incs) << " ns per increment (all threads)\n";
+			};
+
+		std::unordered_map<std::string, std::atomic<std::uint64_t>> by_name;
+		for (const char* name : { "requests", "cache_hits", "cache_misses", "bytes_sent" }) {
+			by_name[name] = 0;
+		}
+		report_per_inc(testing::Benchmark::run("metrics/string-keyed map of atomics (64 threads x 100k incs)", 3, [&]() {
+			testing::run_on_threads(n_threads, [&](size_t) {
+				for (size_t i = 0; i < n_incs; i += 4) {
+					by_name.find("requests")->second.fetch_add(1, std::memory_order_relaxed);
+					by_name.find(i % 8 ? "cache_hits" : "cache_misses")->second.fetch_add(1, std::memory_order_relaxed);
+					by_name.find("bytes_sent")->second.fetch_add(512, std::memory_order_relaxed);
+					by_name.find("requests")->second.fetch_add(1, std::memory_order_relaxed);
+				}
+				});
+			}));
+
+		auto tagged_body = [&](size_t) {
+			for (size_t i = 0; i < n_incs; i += 4) {
+				service_metrics::inc<requests>();
+				if (i % 8) {
+					service_metrics::inc<cache_hits>();
+				}
+				else {
+					service_metrics::inc<cache_misses>();
+				}
+				service_metrics::inc<bytes_sent>(512);
+				service_metrics::inc<requests>();
+			}
+			};
+		report_per_inc(testing::Benchmark::run("metrics/tag slots (64 threads x 100k incs)", 3, [&]() {
+			testing::run_on_threads(n_threads, tagged_body);
+			}));
+
+		{
+			service_metrics::aggregator aggregator{ std::chrono::milliseconds(1) };
+			report_per_inc(testing::Benchmark::run("metrics/tag slots, aggregating every 1 ms (64 threads x 100k incs)", 3, [&]() {
+				testing::run_on_threads(n_threads, tagged_body);
+				}));
+		}
+
+		// Keep 64 threads attached while collecting, so that every snapshot sums 64 blocks.
+		std::atomic<bool> done{ false };
+		std::latch attached{ ptrdiff_t(n_threads) };
+		std::vector<std::thread> idle;
+		for (size_t t = 0; t < n_threads; ++t) {
+			idle.emplace_back([&]() {
+				service_metrics::inc<requests>();
+				attached.count_down();
+				while (!done.load()) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				});
+		}
+		attached.wait();
+		testing::Benchmark::run("metrics/collect snapshot (64 attached threads)", 10000, [&]() {
+			testing::do_not_optimize(service_metrics::collect());
+			});
+		done = true;
+		for (auto& thread : idle) {
+			thread.join();
+		}
+	}
+} // namespace test::bench
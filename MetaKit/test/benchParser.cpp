@@ -0,0 +1,98 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Builds a corpus of order entry messages ("NEW <id> <px> <qty>" and "CXL <id>").
+	   @param n_messages The number of messages to generate.
+	   @return The messages, one per element. */
+	inline std::vector<std::string> make_order_corpus(size_t n_messages) {
+		std::vector<std::string> corpus;
+		corpus.reserve(n_messages);
+		unsigned state = 12345;
+		for (size_t i = 0; i < n_messages; ++i) {
+			state = state * 1103515245u + 12345u;
+			if (state % 4 == 0) {
+				corpus.push_back("CXL " + std::to_string(i));
+			}
+			else {
+				corpus.push_back("NEW " + std::to_string(i) + " " + std::to_string(state % 100000) + " " +
+					std::to_string(1 + state % 500));
+			}
+		}
+		return corpus;
+	}
+
+	/* @brief Hand-written state machine parser for an order message.
+	   @param msg The message to parse.
+	   @param checksum Accumulates the parsed fields.
+	   @return true if the message was well formed. */
+	inline bool parse_order_by_hand(std::string_view msg, long long& checksum) {
+		auto read_int = [&](size_t& i, int& out) {
+			const size_t first = i;
+			out = 0;
+			while (i < msg.size() && msg[i] >= '0' && msg[i] <= '9') {
+				out = out * 10 + (msg[i++] - '0');
+			}
+			return i != first;
+		};
+
+		size_t i = 4;
+		int id = 0, px = 0, qty = 0;
+		if (msg.starts_with("NEW ")) {
+			if (!read_int(i, id) || i >= msg.size() || msg[i++] != ' ' || !read_int(i, px) ||
+				i >= msg.size() || msg[i++] != ' ' || !read_int(i, qty)) {
+				return false;
+			}
+			checksum += id + px + qty;
+			return i == msg.size();
+		}
+		if (msg.starts_with("CXL ")) {
+			if (!read_int(i, id)) {
+				return false;
+			}
+			checksum -= id;
+			return i == msg.size();
+		}
+		return false;
+	}
+
+	/* @brief Compares the combinator grammar against the hand-written parser on the same corpus. */
+	inline void run_parser_benchmarks() {
+		const auto corpus = make_order_corpus(10000);
+
+		constexpr auto new_order = seq(lit("NEW "), int_<>, lit(" "), int_<>, lit(" "), int_<>);
+		constexpr auto cancel = seq(lit("CXL "), int_<>);
+		constexpr auto order = alt(new_order, cancel);
+
+		testing::Benchmark::run("parser/hand_written (10k messages)", 200, [&]() {
+			long long checksum = 0;
+			for (const auto& msg : corpus) {
+				parse_order_by_hand(msg, checksum);
+			}
+			testing::do_not_optimize(checksum);
+			});
+
+		testing::Benchmark::run("parser/combinators (10k messages)", 200, [&]() {
+			long long checksum = 0;
+			for (const auto& msg : corpus) {
+				const auto result = parse(order, msg);
+				if (!result) {
+					continue;
+				}
+				if (result->index() == 0) {
+					const auto& fields = std::get<0>(*result);
+					checksum += get<0>(fields) + get<1>(fields) + get<2>(fields);
+				}
+				else {
+					checksum -= get<0>(std::get<1>(*result));
+				}
+			}
+			testing::do_not_optimize(checksum);
+			});
+	}
+} // namespace test::bench
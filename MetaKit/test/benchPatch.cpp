@@ -0,0 +1,96 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "patch.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	template <size_t... indices>
+	auto make_wide_record(std::index_sequence<indices...>) -> metakit::tuple<std::conditional_t<indices % 2 == 0, double, std::int64_t>...>;
+
+	/* @brief A 32-field record of doubles and integers, 256 bytes serialized. */
+	using wide_record = decltype(make_wide_record(std::make_index_sequence<32>{}));
+
+	/* @brief Creates a record with every field zero. */
+	inline wide_record zero_record() {
+		return []<size_t... indices>(std::index_sequence<indices...>) {
+			return wide_record{ metakit::tuple_element_t<indices, wide_record>(0)... };
+		}(std::make_index_sequence<32>{});
+	}
+
+	/* @brief Adds one to the field at a run-time index. */
+	inline void bump_field(wide_record& record, size_t field) {
+		[&]<size_t... indices>(std::index_sequence<indices...>) {
+			((indices == field ? (void)(metakit::get<indices>(record) += 1) : (void)0), ...);
+		}(std::make_index_sequence<32>{});
+	}
+
+	/* @brief Replicates a stream of updates that each change two fields of a wide record, sending
+	   either the full record or a patch, and compares bytes sent and time per update. */
+	inline void run_patch_benchmarks() {
+		constexpr size_t n_updates = 100000;
+		std::vector<std::pair<std::uint8_t, std::uint8_t>> updates(n_updates);
+		std::uint64_t x = 88172645463325252ull;
+		for (auto& update : updates) {
+			x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+			update = { std::uint8_t(x % 32), std::uint8_t((x >> 8) % 32) };
+		}
+
+		std::array<std::byte, metakit::max_patch_size_v<wide_record>> buffer{};
+		size_t bytes_sent = 0;
+
+		wide_record updated = zero_record();
+		const double update_ns = testing::Benchmark::run("patch/baseline: apply the updates only (100k updates x 2 fields)", 10, [&]() {
+			for (const auto& [a, b] : updates) {
+				bump_field(updated, a);
+				bump_field(updated, b);
+				testing::do_not_optimize(updated);
+			}
+			});
+
+		wide_record full_source = zero_record();
+		const double full_ns = testing::Benchmark::run("patch/full record per update (100k updates x 2 fields)", 10, [&]() {
+			bytes_sent = 0;
+			for (const auto& [a, b] : updates) {
+				bump_field(full_source, a);
+				bump_field(full_source, b);
+				bytes_sent += metakit::serialize(full_source, buffer);
+				testing::do_not_optimize(buffer);
+			}
+			});
+		std::cerr << "          = " << (full_ns - update_ns) / n_updates << " ns over the baseline and " << double(bytes_sent) / n_updates << " bytes per update\n";
+
+		wide_record previous = zero_record();
+		wide_record current = zero_record();
+		const double patch_ns = testing::Benchmark::run("patch/diff + serialize_patch per update (100k updates x 2 fields)", 10, [&]() {
+			bytes_sent = 0;
+			for (const auto& [a, b] : updates) {
+				bump_field(current, a);
+				bump_field(current, b);
+				bytes_sent += metakit::serialize_patch(previous, current, buffer);
+				testing::do_not_optimize(buffer);
+				previous = current;
+			}
+			});
+		std::cerr << "          = " << (patch_ns - update_ns) / n_updates << " ns over the baseline and " << double(bytes_sent) / n_updates << " bytes per update\n";
+
+		wide_record changed = current;
+		bump_field(changed, 3);
+		bump_field(changed, 20);
+		testing::Benchmark::run("patch/diff of two records (2 of 32 fields changed)", 1000000, [&]() {
+			testing::do_not_optimize(metakit::diff(current, changed));
+			});
+
+		wide_record replica = zero_record();
+		const size_t patch_size = metakit::serialize_patch(zero_record(), current, buffer);
+		testing::Benchmark::run("patch/apply_patch (all 32 fields changed)", 100000, [&]() {
+			testing::do_not_optimize(metakit::apply_patch(replica, std::span<const std::byte>(buffer.data(), patch_size)));
+			});
+	}
+} // namespace test::bench
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "histogram.h"
+#include "record_writer.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Measures the latency of a producer appending a record, and the sustained write rate, for a
+	   log written synchronously record by record and for async_record_writer with each of its modes. */
+	inline void run_record_writer_benchmarks() {
+		using record = metakit::tuple<std::uint64_t, std::uint64_t, double, std::uint32_t>; // time, id, value, kind
+		using layout = metakit::histogram_layout<100'000'000, 7>;
+		using clock = std::chrono::steady_clock;
+		constexpr size_t n_producers = 4;
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "metakit_bench_log.bin";
+
+		// Opens the log, runs the producers, each timing every one of its appends, and closes the log; then reports
+		// the percentiles of the timed run and the rate.
+		const auto produce = [&](const char* name, size_t per_producer, const auto& open, const auto& append, const auto& close) {
+			std::optional<metakit::thread_histograms<layout>> latencies;
+			const double mb = double(n_producers * per_producer * sizeof(record)) / 1e6;
+			const std::string label = std::string("record_writer/") + name + " (" + std::to_string(n_producers) + " producers, "
+				+ std::to_string(size_t(mb)) + " MB)";
+			const double ns = testing::Benchmark::run(label, 1, [&]() {
+				latencies.emplace();
+				open();
+				std::vector<std::thread> producers;
+				for (size_t p = 0; p < n_producers; ++p) {
+					producers.emplace_back([&, p] {
+						for (std::uint64_t i = 0; i < per_producer; ++i) {
+							const record r{ i, std::uint64_t(p), double(i) * 0.5, std::uint32_t(i % 16) };
+							const auto before = clock::now();
+							append(r);
+							latencies->record(std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - before).count()));
+						}
+						});
+				}
+				for (auto& producer : producers) {
+					producer.join();
+				}
+				close();
+				});
+			const auto merged = latencies->merged();
+			std::cerr << "          = push latency p50 " << merged.value_at_percentile(50) << " ns, p99 " << merged.value_at_percentile(99)
+				<< " ns, p99.9 " << merged.value_at_percentile(99.9) << " ns, p99.99 " << merged.value_at_percentile(99.99)
+				<< " ns\n          = " << mb / ns * 1e9 << " MB/s including close\n";
+		};
+
+		{
+			// The baseline: a write call per record, under a lock as producers share the file.
+			std::FILE* file = nullptr;
+			std::mutex lock;
+			produce("baseline: unbuffered fwrite per record", 250000, [&] {
+				file = std::fopen(path.string().c_str(), "wb");
+				std::setvbuf(file, nullptr, _IONBF, 0);
+				}, [&](const record& r) {
+				std::lock_guard guard(lock);
+				std::fwrite(&r, sizeof(record), 1, file);
+				}, [&] { std::fclose(file); });
+		}
+
+		struct configuration {
+			const char* name;
+			metakit::record_writer_options options;
+		};
+		for (const configuration& c : {
+			configuration{ "async_record_writer, page cache, sync on close", { size_t(4) << 20, 4, false, metakit::sync_policy::on_close } },
+			configuration{ "async_record_writer, O_DIRECT, sync on close", { size_t(4) << 20, 4, true, metakit::sync_policy::on_close } },
+			configuration{ "async_record_writer, page cache, sync every write", { size_t(4) << 20, 4, false, metakit::sync_policy::every_batch } } }) {
+			std::optional<metakit::async_record_writer<record>> writer;
+			produce(c.name, 2000000, [&] { writer.emplace(path, c.options); },
+				[&](const record& r) { writer->push(r); }, [&] { writer->close(); });
+			const metakit::record_writer_stats stats = writer->stats();
+			std::cerr << "          = " << stats.writes << " writes of " << double(stats.bytes_written) / double(stats.writes) / 1e6
+				<< " MB on average, " << stats.syncs << " syncs, " << stats.producer_waits << " producer waits for a buffer"
+				<< (c.options.direct && !writer->direct() ? " (O_DIRECT unsupported here)" : "") << "\n";
+		}
+		std::filesystem::remove(path);
+	}
+}
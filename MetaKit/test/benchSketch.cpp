@@ -0,0 +1,82 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "sketch.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Measures updates per second of each sketch on 10M composite keys, one by one and batched,
+	   and their errors against exact answers. */
+	inline void run_sketch_benchmarks() {
+		using key = metakit::tuple<std::uint64_t, std::uint32_t>;
+		constexpr size_t n_keys = 10000000;
+		std::vector<key> keys;
+		keys.reserve(n_keys);
+		std::uint64_t x = 88172645463325252ull;
+		for (size_t i = 0; i < n_keys; ++i) {
+			x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+			// Zipf-like: small ids are much more frequent, 1M distinct ids at most.
+			const std::uint64_t id = (x % 1000) * (x >> 20) % 1000000 / ((x >> 40) % 100 + 1);
+			keys.push_back(key{ id, std::uint32_t(id % 7) });
+		}
+		const auto print_rate = [](double ns) { std::cerr << "          = " << double(n_keys) / ns * 1e3 << " M updates/s\n"; };
+
+		metakit::hyperloglog<14> distinct;
+		print_rate(testing::Benchmark::run("sketch/hyperloglog<14> add (10M keys)", 1, [&]() {
+			for (const key& k : keys) {
+				distinct.add(k);
+			}
+			}));
+		distinct.clear();
+		print_rate(testing::Benchmark::run("sketch/hyperloglog<14> add_many (10M keys)", 1, [&]() {
+			distinct.add_many(std::span<const key>(keys));
+			}));
+
+		metakit::count_min<4096, 4> frequencies;
+		print_rate(testing::Benchmark::run("sketch/count_min<4096, 4> add_many (10M keys)", 1, [&]() {
+			frequencies.add_many(std::span<const key>(keys));
+			}));
+
+		std::vector<double> values(n_keys);
+		for (size_t i = 0; i < n_keys; ++i) {
+			values[i] = double(metakit::get<0>(keys[i]));
+		}
+		metakit::kll_sketch<double> quantiles;
+		print_rate(testing::Benchmark::run("sketch/kll_sketch<double> add_many (10M values)", 1, [&]() {
+			quantiles.add_many(std::span<const double>(values));
+			}));
+
+		std::unordered_map<key, std::uint64_t, metakit::tuple_hash, metakit::tuple_equal> exact;
+		print_rate(testing::Benchmark::run("sketch/exact unordered_map counts (10M keys)", 1, [&]() {
+			for (const key& k : keys) {
+				++exact[k];
+			}
+			}));
+
+		const double overcount_bound = std::exp(1.0) / 4096 * double(n_keys);
+		size_t beyond_bound = 0;
+		for (const auto& [k, n] : exact) {
+			beyond_bound += double(frequencies.estimate(k) - n) > overcount_bound;
+		}
+		std::sort(values.begin(), values.end());
+		double worst_rank_error = 0;
+		for (const double q : { 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99 }) {
+			const double v = quantiles.quantile(q);
+			const double rank = double(std::upper_bound(values.begin(), values.end(), v) - values.begin()) / double(n_keys);
+			worst_rank_error = std::max(worst_rank_error, std::abs(rank - q));
+		}
+		std::cerr << "          = hyperloglog: " << distinct.estimate() << " distinct vs " << exact.size() << " exact ("
+			<< 100 * (distinct.estimate() / double(exact.size()) - 1) << "%, bound +-" << 100 * 1.04 / 128 << "% at 1 sigma)\n"
+			<< "          = count_min: " << 100 * double(beyond_bound) / double(exact.size()) << "% of keys overcounted by more than "
+			<< overcount_bound << " (bound: " << 100 * std::exp(-4.0) << "%)\n"
+			<< "          = kll_sketch: worst rank error " << worst_rank_error << " holding " << quantiles.retained() << " values\n"
+			<< "          = memory: hyperloglog " << sizeof(distinct) << " B, count_min " << sizeof(frequencies) << " B, exact map ~"
+			<< exact.size() * (sizeof(key) + 8 + 16) << " B\n";
+	}
+} // namespace test::bench
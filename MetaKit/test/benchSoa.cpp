@@ -0,0 +1,85 @@
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "soa.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief A 64-byte plain struct, of which a typical scan reads one or two fields. */
+	struct soa_order {
+		std::uint64_t id;
+		double price;
+		std::int32_t quantity;
+		std::int32_t side;
+		double fee;
+		std::uint64_t timestamp;
+		std::array<char, 24> venue;
+	};
+
+	/* @brief Compares soa_of<soa_order> with vector<soa_order> for filling and for scans over one and two fields. */
+	inline void run_soa_benchmarks() {
+		constexpr size_t n_orders = 4000000;
+		std::vector<soa_order> rows;
+		metakit::soa_of<soa_order> columns;
+
+		testing::Benchmark::run("soa/vector<struct> push_back (4M orders)", 3, [&]() {
+			rows.clear();
+			for (std::uint64_t i = 0; i < n_orders; ++i) {
+				rows.push_back(soa_order{ i, double(i % 1000), std::int32_t(i % 50), 1, 0.5, i, {} });
+			}
+			testing::do_not_optimize(rows.data());
+			});
+		testing::Benchmark::run("soa/soa_of push_back (4M orders)", 3, [&]() {
+			columns.clear();
+			for (std::uint64_t i = 0; i < n_orders; ++i) {
+				columns.push_back(soa_order{ i, double(i % 1000), std::int32_t(i % 50), 1, 0.5, i, {} });
+			}
+			testing::do_not_optimize(columns.column<0>().data());
+			});
+
+		const double rows_one = testing::Benchmark::run("soa/vector<struct> sum of price (4M orders)", 10, [&]() {
+			double total = 0;
+			for (const soa_order& o : rows) {
+				total += o.price;
+			}
+			testing::do_not_optimize(total);
+			});
+		const double columns_one = testing::Benchmark::run("soa/soa_of sum of price (4M orders)", 10, [&]() {
+			double total = 0;
+			for (const double price : columns.column<&soa_order::price>()) {
+				total += price;
+			}
+			testing::do_not_optimize(total);
+			});
+		std::cerr << "          = " << rows_one / columns_one << "x faster with columns\n";
+
+		const double rows_two = testing::Benchmark::run("soa/vector<struct> sum of price * quantity (4M orders)", 10, [&]() {
+			double total = 0;
+			for (const soa_order& o : rows) {
+				total += o.price * o.quantity;
+			}
+			testing::do_not_optimize(total);
+			});
+		const double columns_two = testing::Benchmark::run("soa/soa_of sum of price * quantity (4M orders)", 10, [&]() {
+			const auto prices = columns.column<&soa_order::price>();
+			const auto quantities = columns.column<&soa_order::quantity>();
+			double total = 0;
+			for (size_t i = 0; i < prices.size(); ++i) {
+				total += prices[i] * quantities[i];
+			}
+			testing::do_not_optimize(total);
+			});
+		std::cerr << "          = " << rows_two / columns_two << "x faster with columns\n";
+
+		testing::Benchmark::run("soa/soa_of sum of price through proxies (4M orders)", 10, [&]() {
+			double total = 0;
+			for (size_t i = 0; i < columns.size(); ++i) {
+				total += columns[i].get<&soa_order::price>();
+			}
+			testing::do_not_optimize(total);
+			});
+	}
+} // namespace test::bench
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "trace.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	struct trace_order { std::uint64_t id; double price; std::uint32_t quantity; };
+	struct trace_fill { std::uint64_t id; std::uint32_t venue; };
+	using order_tracer = metakit::tracer<metakit::type_list<trace_order, trace_fill>, (size_t(1) << 22)>;
+
+	/* @brief Measures the hot-path cost of emitting an event while a flusher writes the rings to a
+	   file, next to the cost of the bare tick counter read, and the offline decoding rate. */
+	inline void run_trace_benchmarks() {
+		constexpr size_t n_events = 1000000;
+		const std::string path = (std::filesystem::temp_directory_path() / "metakit_bench_trace.bin").string();
+
+		testing::Benchmark::run("trace/tick counter read", n_events, []() {
+			testing::do_not_optimize(metakit::detail::trace_ticks());
+			});
+
+		double emit_ns = 0;
+		std::uint64_t i = 0;
+		{
+			order_tracer::flusher flusher{ path, std::chrono::milliseconds(1) };
+			emit_ns = testing::Benchmark::run("trace/emit with background flusher (1M events)", n_events, [&]() {
+				if (++i % 4)
+					order_tracer::emit(trace_order{ i, double(i) * 0.25, std::uint32_t(i) });
+				else
+					order_tracer::emit(trace_fill{ i, std::uint32_t(i % 7) });
+				});
+		}
+
+		std::uint64_t checksum = 0;
+		std::optional<metakit::trace_summary> summary;
+		const auto start = std::chrono::steady_clock::now();
+		{
+			std::ifstream file{ path, std::ios::binary };
+			summary = order_tracer::decode(file, [&](const metakit::trace_event_info& info, const auto& event) {
+				checksum += info.ticks ^ event.id;
+				});
+		}
+		const double decode_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		testing::do_not_optimize(checksum);
+		std::filesystem::remove(path);
+
+		if (summary) {
+			std::cerr << "          = " << emit_ns << " ns per event; " << summary->events << " decoded, "
+				<< summary->dropped << " dropped, " << summary->chunks << " chunks, "
+				<< decode_ns / double(summary->events ? summary->events : 1) << " ns per decoded event\n";
+		}
+		else {
+			std::cerr << "          trace file could not be decoded\n";
+		}
+	}
+} // namespace test::bench
@@ -0,0 +1,117 @@
+#include <tuple>
+#include <vector>
+
+#include "tuple.h"
+#include "testCopying.cpp"
+
+namespace test::bench
+{
+	/* @brief Plain struct with the same fields as the benchmarked tuples, the baseline for field access. */
+	struct access_row {
+		long a;
+		int b;
+		short c;
+		long d;
+	};
+
+	/* @brief Reads every field of every row, the access pattern that dominates the debug test suite.
+	   Meant to be compared across build configurations, in particular -O0 against -O2. */
+	inline void run_tuple_access_benchmarks() {
+		constexpr size_t n_rows = 4096;
+		std::vector<metakit::tuple<long, int, short, long>> mk_rows;
+		std::vector<std::tuple<long, int, short, long>> std_rows;
+		std::vector<access_row> plain_rows;
+		for (size_t i = 0; i < n_rows; ++i) {
+			mk_rows.push_back(metakit::make_tuple(long(i), int(i), short(i), long(i)));
+			std_rows.push_back(std::make_tuple(long(i), int(i), short(i), long(i)));
+			plain_rows.push_back({ long(i), int(i), short(i), long(i) });
+		}
+
+		testing::Benchmark::run("tuple_access/struct (4 fields x 4096 rows)", 1000, [&]() {
+			long sum = 0;
+			for (const auto& row : plain_rows) {
+				sum += row.a + row.b + row.c + row.d;
+			}
+			testing::do_not_optimize(sum);
+			});
+
+		testing::Benchmark::run("tuple_access/std::tuple (4 fields x 4096 rows)", 1000, [&]() {
+			long sum = 0;
+			for (const auto& row : std_rows) {
+				sum += std::get<0>(row) + std::get<1>(row) + std::get<2>(row) + std::get<3>(row);
+			}
+			testing::do_not_optimize(sum);
+			});
+
+		testing::Benchmark::run("tuple_access/metakit::tuple (4 fields x 4096 rows)", 1000, [&]() {
+			long sum = 0;
+			for (const auto& row : mk_rows) {
+				sum += metakit::get<0>(row) + metakit::get<1>(row) + metakit::get<2>(row) + metakit::get<3>(row);
+			}
+			testing::do_not_optimize(sum);
+			});
+
+		testing::Benchmark::run("tuple_access/metakit::tuple rvalue (4 fields x 4096 rows)", 1000, [&]() {
+			long sum = 0;
+			for (auto& row : mk_rows) {
+				sum += metakit::get<3>(metakit::move(row));
+			}
+			testing::do_not_optimize(sum);
+			});
+	}
+
+	/* @brief Compares tuple operations of metakit against std::tuple, and a scan of one field over
+	   rows (AoS) against the same scan over a column (SoA). Run with --bench --perf to see the
+	   cycles, instructions and misses behind the times. */
+	inline void run_tuple_layout_benchmarks() {
+		constexpr size_t n_rows = 1 << 20;
+
+		std::vector<long> inputs;
+		for (long i = 0; i < 1024; ++i) {
+			inputs.push_back((i * 7919) % 1024);
+		}
+
+		testing::Benchmark::run("tuple_ops/metakit make_tuple + tuple_cat + get (1024 rows)", 1000, [&]() {
+			long sum = 0;
+			for (const long i : inputs) {
+				const auto row = metakit::tuple_cat(metakit::make_tuple(i, int(i)), metakit::make_tuple(short(i), i));
+				sum += metakit::get<0>(row) + metakit::get<1>(row) + metakit::get<2>(row) + metakit::get<3>(row);
+			}
+			testing::do_not_optimize(sum);
+			});
+
+		testing::Benchmark::run("tuple_ops/std make_tuple + tuple_cat + get (1024 rows)", 1000, [&]() {
+			long sum = 0;
+			for (const long i : inputs) {
+				const auto row = std::tuple_cat(std::make_tuple(i, int(i)), std::make_tuple(short(i), i));
+				sum += std::get<0>(row) + std::get<1>(row) + std::get<2>(row) + std::get<3>(row);
+			}
+			testing::do_not_optimize(sum);
+			});
+
+		std::vector<metakit::tuple<long, int, short, long>> rows;
+		rows.reserve(n_rows);
+		std::vector<short> column;
+		column.reserve(n_rows);
+		for (size_t i = 0; i < n_rows; ++i) {
+			rows.push_back(metakit::make_tuple(long(i), int(i), short(i), long(i)));
+			column.push_back(short(i));
+		}
+
+		testing::Benchmark::run("tuple_layout/AoS scan of one field (1M rows)", 100, [&]() {
+			long sum = 0;
+			for (const auto& row : rows) {
+				sum += metakit::get<2>(row);
+			}
+			testing::do_not_optimize(sum);
+			});
+
+		testing::Benchmark::run("tuple_layout/SoA scan of one column (1M rows)", 100, [&]() {
+			long sum = 0;
+			for (const short value : column) {
+				sum += value;
+			}
+			testing::do_not_optimize(sum);
+			});
+	}
+} // namespace test::bench
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "testCopying.cpp"
+#include "window.h"
+
+namespace test::bench
+{
+	using window_event = metakit::tuple<std::int64_t, double, std::int32_t>;
+	using window_aggregators = metakit::type_list<metakit::aggregate::sum<2>, metakit::aggregate::min<1>,
+		metakit::aggregate::max<1>, metakit::aggregate::count>;
+
+	/* @brief Prints events per second for a benchmark over n_events events. */
+	inline void print_event_rate(double ns, size_t n_events) {
+		std::cerr << "          = " << double(n_events) / ns * 1e3 << " M events/s\n";
+	}
+
+	/* @brief Streams 10M events, about 2000 per sliding window, through the window operators, and
+	   compares the sliding window with recomputing each window from scratch. */
+	inline void run_window_benchmarks() {
+		constexpr size_t n_events = 10000000;
+		std::vector<window_event> events;
+		events.reserve(n_events);
+		std::uint64_t x = 88172645463325252ull;
+		std::int64_t now = 0;
+		for (size_t i = 0; i < n_events; ++i) {
+			x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+			now += std::int64_t(x % 3);
+			events.push_back(window_event{ now, double(x % 10000) / 100, std::int32_t(x % 500) });
+		}
+
+		const double sliding_ns = testing::Benchmark::run("window/sliding, sum + min + max + count (10M events, window 2000 time units)", 1, [&]() {
+			metakit::sliding_window<window_event, 0, window_aggregators> window(2000);
+			double checksum = 0;
+			for (const window_event& e : events) {
+				const auto values = window.push(e);
+				checksum += double(metakit::get<0>(values)) + metakit::get<1>(values) + metakit::get<2>(values);
+			}
+			testing::do_not_optimize(checksum);
+			});
+		print_event_rate(sliding_ns, n_events);
+
+		constexpr size_t n_recomputed = 100000;
+		const double recompute_ns = testing::Benchmark::run("window/recompute each window from scratch (100k events, window 2000 time units)", 1, [&]() {
+			double checksum = 0;
+			size_t first = 0;
+			for (size_t i = 0; i < n_recomputed; ++i) {
+				while (metakit::get<0>(events[first]) + 2000 <= metakit::get<0>(events[i])) {
+					++first;
+				}
+				std::int64_t volume = 0;
+				double low = metakit::get<1>(events[first]), high = low;
+				for (size_t j = first; j <= i; ++j) {
+					volume += metakit::get<2>(events[j]);
+					low = std::min(low, metakit::get<1>(events[j]));
+					high = std::max(high, metakit::get<1>(events[j]));
+				}
+				checksum += double(volume) + low + high + double(i + 1 - first);
+			}
+			testing::do_not_optimize(checksum);
+			});
+		print_event_rate(recompute_ns, n_recomputed);
+
+		const double tumbling_ns = testing::Benchmark::run("window/tumbling, sum + min + max + count (10M events, window 2000 time units)", 1, [&]() {
+			metakit::tumbling_window<window_event, 0, window_aggregators> window(2000);
+			double checksum = 0;
+			for (const window_event& e : events) {
+				if (const auto closed = window.push(e)) {
+					checksum += metakit::get<1>(closed->values);
+				}
+			}
+			testing::do_not_optimize(checksum);
+			});
+		print_event_rate(tumbling_ns, n_events);
+
+		const double session_ns = testing::Benchmark::run("window/session, sum + min + max + count (10M events, gap 1 time unit)", 1, [&]() {
+			metakit::session_window<window_event, 0, window_aggregators> window(1);
+			double checksum = 0;
+			for (const window_event& e : events) {
+				if (const auto closed = window.push(e)) {
+					checksum += double(closed->records);
+				}
+			}
+			testing::do_not_optimize(checksum);
+			});
+		print_event_rate(session_ns, n_events);
+	}
+} // namespace test::bench
@@ -0,0 +1,118 @@
+#!/bin/sh
+# Code generation regression test for the zero-overhead claim.
+#
+# Usage: test/codegen.sh [compiler...]   (defaults to g++ and clang++ when found)
+#        UPDATE=1 test/codegen.sh ...     rewrites the budgets with the current counts
+#
+# test/testCodegen.cpp is compiled with -O2 and every mk_<case> function is disassembled
+# with objdump. A case fails when it
+#   - contains a call (or a tail call through a relocation),
+#   - has more instructions than its std_<case> counterpart, or
+#   - has more instructions than recorded in test/codegen_budget.<compiler>.txt.
+# The summed symbol sizes of the mk_ functions are tracked in the same file as ".text".
+# Budgets are per compiler because instruction selection differs; a compiler without a
+# budget file only gets the call and std::tuple checks. Instruction patterns are x86-64
+# and AArch64.
+#
+# The file is also compiled with -O0, where mk_get may make at most one call: debug builds
+# must not pay for a chain of helper calls per field access.
+
+set -eu
+
+here=$(cd "$(dirname "$0")" && pwd)
+lib="$here/../lib"
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+compilers="$*"
+if [ -z "$compilers" ]; then
+    for cxx in g++ clang++; do
+        command -v "$cxx" >/dev/null 2>&1 && compilers="$compilers $cxx"
+    done
+fi
+
+failed=0
+
+# fail <message>
+fail() {
+    echo "FAIL: $*"
+    failed=1
+}
+
+# symbol_info <object> <symbol>: prints "<instructions> <bytes> <calls>".
+symbol_info() {
+    set -- "$1" "$2" $(nm -S "$1" | awk -v s="$2" '$4 == s { print $1, $2 }')
+    if [ "$#" -ne 4 ]; then
+        echo "missing symbol $2" >&2
+        exit 1
+    fi
+    start=$((0x$3)); size=$((0x$4))
+    objdump -dr --no-show-raw-insn --section=.text --start-address="$start" \
+            --stop-address="$((start + size))" "$1" | awk -v size="$size" '
+        # Direct calls and tail calls carry a relocation against the callee.
+        /^[ \t]+[0-9a-f]+: R_/ {
+            if ($2 ~ /PLT32|CALL26|JUMP26/) calls++
+            next
+        }
+        /^[ \t]+[0-9a-f]+:/ {
+            insns++
+            if (($2 ~ /^call/ && $3 ~ /^\*/) || $2 == "blr") calls++
+        }
+        END { printf "%d %d %d\n", insns, size, calls }'
+}
+
+for cxx in $compilers; do
+    obj="$tmp/codegen.o"
+    "$cxx" -std=c++20 -O2 -I"$lib" -c "$here/testCodegen.cpp" -o "$obj"
+
+    budget="$here/codegen_budget.$(basename "$cxx").txt"
+    cases=$(nm "$obj" | awk '$2 == "T" && $3 ~ /^mk_/ { sub(/^mk_/, "", $3); print $3 }' | sort)
+
+    echo "[ CODEGEN ] $cxx -O2"
+    text_mk=0
+    text_std=0
+    new_budget=""
+    for case in $cases; do
+        set -- $(symbol_info "$obj" "mk_$case")
+        mk_insns=$1; mk_bytes=$2; mk_calls=$3
+        set -- $(symbol_info "$obj" "std_$case")
+        std_insns=$1; std_bytes=$2
+        text_mk=$((text_mk + mk_bytes))
+        text_std=$((text_std + std_bytes))
+        new_budget="$new_budget$case $mk_insns
+"
+        printf '  %-18s metakit %3d insns %4d bytes   std::tuple %3d insns %4d bytes\n' \
+            "$case" "$mk_insns" "$mk_bytes" "$std_insns" "$std_bytes"
+
+        [ "$mk_calls" -eq 0 ] || fail "$cxx $case: mk_$case contains $mk_calls call(s)"
+        [ "$mk_insns" -le "$std_insns" ] || fail "$cxx $case: $mk_insns instructions, std::tuple needs $std_insns"
+        if [ -f "$budget" ] && [ -z "${UPDATE:-}" ]; then
+            limit=$(awk -v c="$case" '$1 == c { print $2 }' "$budget")
+            if [ -n "$limit" ] && [ "$mk_insns" -gt "$limit" ]; then
+                fail "$cxx $case: $mk_insns instructions, budget is $limit"
+            fi
+        fi
+    done
+    printf '  %-18s metakit %4d bytes   std::tuple %4d bytes\n' ".text" "$text_mk" "$text_std"
+
+    "$cxx" -std=c++20 -O0 -I"$lib" -c "$here/testCodegen.cpp" -o "$obj"
+    set -- $(symbol_info "$obj" mk_get)
+    printf '  %-18s metakit %3d insns %4d calls at -O0\n' "get" "$1" "$3"
+    [ "$3" -le 1 ] || fail "$cxx get: $3 calls at -O0, at most 1 allowed"
+
+    if [ -n "${UPDATE:-}" ]; then
+        printf '# Instruction budgets of test/testCodegen.cpp at -O2; regenerate with UPDATE=1 test/codegen.sh %s\n%s.text %d\n' \
+            "$cxx" "$new_budget" "$text_mk" > "$budget"
+        echo "  budget written to $(basename "$budget")"
+    elif [ -f "$budget" ]; then
+        limit=$(awk '$1 == ".text" { print $2 }' "$budget")
+        if [ -n "$limit" ] && [ "$text_mk" -gt "$limit" ]; then
+            fail "$cxx .text: $text_mk bytes, budget is $limit"
+        fi
+    else
+        echo "  no $(basename "$budget"); run with UPDATE=1 to record one"
+    fi
+done
+
+[ "$failed" -eq 0 ] && echo "[ CODEGEN ] all cases passed"
+exit "$failed"
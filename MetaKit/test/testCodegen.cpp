@@ -0,0 +1,86 @@
+#include <tuple>
+
+#include "tuple.h"
+
+/* @brief Code generation cases: every MetaKit operation next to its std::tuple equivalent.
+   Not linked into the test runner; test/codegen.sh compiles this file at -O2 and inspects
+   the object code of each mk_<case> / std_<case> pair. The functions have C linkage so that
+   their symbols are the plain case names, and every result depends on all inputs so that
+   nothing can be folded away. */
+
+namespace test::codegen
+{
+	template <typename T>
+	struct is_int : metakit::bool_constant<metakit::is_integral_v<T>> {};
+
+	template <typename T>
+	struct std_is_int : std::bool_constant<std::is_integral_v<T>> {};
+
+	/* @brief std::tuple counterpart of metakit::filter, the usual tuple_cat of conditional tuples. */
+	template <template <typename> class Pred, typename... Ts>
+	constexpr auto std_filter(const std::tuple<Ts...>& t) {
+		return std::apply([](const auto&... e) {
+			return std::tuple_cat([&]() {
+				if constexpr (Pred<std::remove_cvref_t<decltype(e)>>::value) {
+					return std::tuple<std::remove_cvref_t<decltype(e)>>{ e };
+				}
+				else {
+					return std::tuple<>{};
+				}
+				}()...);
+			}, t);
+	}
+} // namespace test::codegen
+
+using mk3 = metakit::tuple<int, long, short>;
+using std3 = std::tuple<int, long, short>;
+
+extern "C" {
+	/* get<I>: a single load. */
+	long mk_get(const mk3& t) { return metakit::get<1>(t); }
+	long std_get(const std3& t) { return std::get<1>(t); }
+
+	/* make_tuple: the tuple is never materialized. */
+	long mk_make_tuple(int a, long b, short c) {
+		const auto t = metakit::make_tuple(a, b, c);
+		return metakit::get<0>(t) + metakit::get<1>(t) + metakit::get<2>(t);
+	}
+	long std_make_tuple(int a, long b, short c) {
+		const auto t = std::make_tuple(a, b, c);
+		return std::get<0>(t) + std::get<1>(t) + std::get<2>(t);
+	}
+
+	/* make_tuple into memory: one store per element. */
+	void mk_make_tuple_store(mk3* out, int a, long b, short c) { *out = metakit::make_tuple(a, b, c); }
+	void std_make_tuple_store(std3* out, int a, long b, short c) { *out = std::make_tuple(a, b, c); }
+
+	/* tuple_cat: loads of the elements that are used, nothing else. */
+	long mk_tuple_cat(const metakit::tuple<int, long>& a, const metakit::tuple<short, char>& b) {
+		const auto t = metakit::tuple_cat(a, b);
+		return metakit::get<0>(t) + metakit::get<1>(t) + metakit::get<2>(t) + metakit::get<3>(t);
+	}
+	long std_tuple_cat(const std::tuple<int, long>& a, const std::tuple<short, char>& b) {
+		const auto t = std::tuple_cat(a, b);
+		return std::get<0>(t) + std::get<1>(t) + std::get<2>(t) + std::get<3>(t);
+	}
+
+	/* transform: the element-wise arithmetic only. */
+	long mk_transform(const mk3& t) {
+		const auto u = metakit::transform(t, [](auto e) { return e * 2 + 1; });
+		return metakit::get<0>(u) + metakit::get<1>(u) + metakit::get<2>(u);
+	}
+	long std_transform(const std3& t) {
+		const auto u = std::apply([](auto... e) { return std::make_tuple((e * 2 + 1)...); }, t);
+		return std::get<0>(u) + std::get<1>(u) + std::get<2>(u);
+	}
+
+	/* filter: loads of the kept elements only. */
+	long mk_filter(const metakit::tuple<int, double, long, float>& t) {
+		const auto u = metakit::filter<test::codegen::is_int>(t);
+		return metakit::get<0>(u) + metakit::get<1>(u);
+	}
+	long std_filter(const std::tuple<int, double, long, float>& t) {
+		const auto u = test::codegen::std_filter<test::codegen::std_is_int>(t);
+		return std::get<0>(u) + std::get<1>(u);
+	}
+}
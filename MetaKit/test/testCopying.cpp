@@ -1,15 +1,36 @@
+#pragma once
+
 #include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <iostream>
+#include <latch>
+#include <memory>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "tuple.h"
 #include "type_list.h"
 #include "helper_.h"
+#include "histogram.h"
 
 using namespace metakit;
 
@@ -148,7 +169,7 @@ namespace test::testing {
 	   @param expr The expression to evaluate. */
 #define ASSERT(expr)                                                                                    \
 	if (!(expr)) {                                                                                        \
-		throw test::testing::AssertEqFailed{__FILE__, size_t(__LINE__), std::string{"ASSERT("} + #expr + ")"}; \
+		throw test::testing::AssertFailed{__FILE__, size_t(__LINE__), std::string{"ASSERT("} + #expr + ")"};   \
 	}
 
 	   /* @brief Macro to assert that two values are equal.
@@ -244,6 +265,252 @@ namespace test::testing {
 		}
 	};
 
+	/* @brief Prevents the optimizer from discarding a value computed by a benchmark body.
+	   @param value The value to keep alive. */
+	template <typename T>
+	inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	/* @brief Hardware counters of the calling thread around a benchmark body, read with perf_event_open.
+	   Each counter is opened on its own, so that the available ones are reported even when others
+	   are not; without Linux, or where perf access is denied (containers, perf_event_paranoid),
+	   no counter is available and benchmarks only report time. */
+	class PerfCounters {
+	public:
+		enum Counter { cycles, instructions, cache_misses, branch_misses, counter_count };
+		static constexpr std::array<std::string_view, counter_count> names = { "cycles", "instructions", "cache-misses", "branch-misses" };
+
+		/* @brief Counter values over one measurement; empty for counters that are unavailable. */
+		using Reading = std::array<std::optional<double>, counter_count>;
+
+		PerfCounters() {
+#if defined(__linux__)
+			constexpr std::array<std::uint64_t, counter_count> configs = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+				PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+			for (size_t i = 0; i < counter_count; ++i) {
+				perf_event_attr attr{};
+				attr.size = sizeof(attr);
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = configs[i];
+				attr.disabled = 1;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+				fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+				if (fds[i] < 0 && error.empty()) {
+					error = std::strerror(errno);
+				}
+			}
+#else
+			error = "perf_event_open requires Linux";
+#endif
+		}
+
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+
+		~PerfCounters() {
+#if defined(__linux__)
+			for (int fd : fds) {
+				if (fd >= 0) {
+					close(fd);
+				}
+			}
+#endif
+		}
+
+		/* @brief Checks whether at least one counter could be opened. */
+		bool any_available() const {
+			for (int fd : fds) {
+				if (fd >= 0) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/* @brief Retrieves why the first unavailable counter could not be opened, or an empty string. */
+		const std::string& unavailable_reason() const { return error; }
+
+		/* @brief Zeroes and starts the available counters. */
+		void start() {
+#if defined(__linux__)
+			for (int fd : fds) {
+				if (fd >= 0) {
+					ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+					ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+				}
+			}
+#endif
+		}
+
+		/* @brief Stops the counters and reads them, scaled up if the kernel multiplexed them.
+		   @return The values since start. */
+		Reading stop() {
+			Reading reading{};
+#if defined(__linux__)
+			for (int fd : fds) {
+				if (fd >= 0) {
+					ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+				}
+			}
+			for (size_t i = 0; i < counter_count; ++i) {
+				std::uint64_t values[3]{}; // value, time enabled, time running
+				if (fds[i] >= 0 && read(fds[i], values, sizeof(values)) == ssize_t(sizeof(values)) && values[2] > 0) {
+					reading[i] = double(values[0]) * double(values[1]) / double(values[2]);
+				}
+			}
+#endif
+			return reading;
+		}
+
+	private:
+		std::array<int, counter_count> fds{ -1, -1, -1, -1 };
+		std::string error;
+	};
+
+	/* @brief Class to time benchmark bodies and report the mean time per iteration. */
+	class Benchmark {
+		static constexpr std::string_view color_reset = "\033[0m";
+		static constexpr std::string_view color_cyan = "\033[36m";
+
+	public:
+		/* @brief Buckets for per-iteration latencies: up to 10 s, to 1/128 relative precision. */
+		using latency_layout = histogram_layout<10'000'000'000, 7>;
+
+		/* @brief Also reports hardware counters per iteration for every benchmark, where available. */
+		static inline bool collect_counters = false;
+
+		/* @brief Runs a benchmark body repeatedly and prints the mean time per iteration.
+		   @param bench_name The name of the benchmark to display.
+		   @param iterations The number of timed calls of the body.
+		   @param function The benchmark body; it is called once untimed to warm up.
+		   @return The mean time per iteration in nanoseconds. */
+		template <typename FUNC>
+		static double run(std::string_view bench_name, size_t iterations, FUNC&& function) {
+			function();
+
+			std::optional<PerfCounters> counters;
+			if (collect_counters) {
+				counters.emplace();
+				counters->start();
+			}
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				function();
+			}
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			const PerfCounters::Reading reading = counters ? counters->stop() : PerfCounters::Reading{};
+
+			const double ns_per_iteration =
+				std::chrono::duration<double, std::nano>(elapsed).count() / double(iterations ? iterations : 1);
+			print_result(bench_name, iterations, ns_per_iteration);
+			if (counters) {
+				print_counters(*counters, reading, iterations);
+			}
+			return ns_per_iteration;
+		}
+
+		/* @brief Like run, but times every call of the body and also prints the latency percentiles.
+		   Meant for bodies of a microsecond or more, since each call adds two clock reads.
+		   @param bench_name The name of the benchmark to display.
+		   @param iterations The number of timed calls of the body.
+		   @param function The benchmark body; it is called once untimed to warm up.
+		   @return The latencies of the timed calls, in nanoseconds. */
+		template <typename FUNC>
+		static histogram<latency_layout> run_with_latencies(std::string_view bench_name, size_t iterations, FUNC&& function) {
+			function();
+
+			histogram<latency_layout> latencies;
+			std::chrono::steady_clock::duration total{};
+			for (size_t i = 0; i < iterations; ++i) {
+				const auto start = std::chrono::steady_clock::now();
+				function();
+				const auto elapsed = std::chrono::steady_clock::now() - start;
+				total += elapsed;
+				latencies.record(std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+			}
+
+			print_result(bench_name, iterations,
+				std::chrono::duration<double, std::nano>(total).count() / double(iterations ? iterations : 1));
+			print_latencies(latencies);
+			return latencies;
+		}
+
+		/* @brief Prints hardware counters per iteration below a benchmark result, or why there are none.
+		   @param counters The counters the reading came from.
+		   @param reading The counter values over all timed iterations.
+		   @param iterations The number of timed iterations. */
+		static void print_counters(const PerfCounters& counters, const PerfCounters::Reading& reading, size_t iterations) {
+			if (!counters.any_available()) {
+				std::cerr << "          perf counters unavailable: " << counters.unavailable_reason() << "\n";
+				return;
+			}
+			const double n = double(iterations ? iterations : 1);
+			std::cerr << "         ";
+			for (size_t i = 0; i < PerfCounters::counter_count; ++i) {
+				std::cerr << ' ' << PerfCounters::names[i] << ' ';
+				if (reading[i]) {
+					std::cerr << *reading[i] / n;
+				}
+				else {
+					std::cerr << "n/a";
+				}
+			}
+			if (reading[PerfCounters::cycles] && reading[PerfCounters::instructions] && *reading[PerfCounters::cycles] > 0) {
+				std::cerr << " IPC " << *reading[PerfCounters::instructions] / *reading[PerfCounters::cycles];
+			}
+			std::cerr << " (per iter)\n";
+		}
+
+		/* @brief Prints the percentiles of a latency histogram below a benchmark result.
+		   @param latencies The latencies in nanoseconds. */
+		template <typename Layout>
+		static void print_latencies(const histogram<Layout>& latencies) {
+			std::cerr << "          p50 " << latencies.value_at_percentile(50)
+				<< " ns, p90 " << latencies.value_at_percentile(90)
+				<< " ns, p99 " << latencies.value_at_percentile(99)
+				<< " ns, p99.9 " << latencies.value_at_percentile(99.9)
+				<< " ns, max " << latencies.value_at_percentile(100) << " ns\n";
+		}
+
+	private:
+		/* @brief Prints the result of a benchmark.
+		   @param bench_name The name of the benchmark.
+		   @param iterations The number of timed iterations.
+		   @param ns_per_iteration The mean time per iteration in nanoseconds. */
+		static void print_result(std::string_view bench_name, size_t iterations, double ns_per_iteration) {
+			std::cerr << color_cyan << "[ BENCH ] " << color_reset << bench_name << ": " << ns_per_iteration
+				<< " ns/iter (" << iterations << " iters)\n";
+		}
+	};
+
+	/* @brief Runs body(thread_index) on n_threads threads released together and waits for all of them.
+	   @param n_threads The number of threads.
+	   @param body The per-thread work. */
+	template <typename FUNC>
+	inline void run_on_threads(size_t n_threads, const FUNC& body) {
+		std::latch start{ ptrdiff_t(n_threads) + 1 };
+		std::vector<std::thread> threads;
+		threads.reserve(n_threads);
+		for (size_t t = 0; t < n_threads; ++t) {
+			threads.emplace_back([&, t]() {
+				start.arrive_and_wait();
+				body(t);
+				});
+		}
+		start.arrive_and_wait();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
 	/* @brief Enumeration for different configurations of value references. */
 	enum class Configuration { non_const_lvalue = 0, const_lvalue, non_const_rvalue, const_rvalue };
 	static constexpr std::array<std::string_view, 4> g_config_string = { "&", "const &", "&&", "const &&" };
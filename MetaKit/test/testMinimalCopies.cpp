@@ -0,0 +1,128 @@
+#pragma once
+
+#include <tuple>
+
+#include "tuple.h"
+#include "testCopying.cpp"
+
+/* @brief Checks that the public tuple operations perform the theoretical minimum of element
+   copies and moves, for every value category of their arguments.
+
+   The minimum follows from the argument alone: an element that ends up in a new tuple is
+   moved once if it comes from a non-const rvalue and copied once otherwise; an element that
+   is only referenced or that is dropped is neither copied nor moved. Comparing with std::tuple
+   (as the constructor, make_tuple and tuple_cat tests do) would also pass if both copied too
+   much. */
+namespace test::minimal_copies
+{
+	using testing::Builder;
+	using testing::Configuration;
+
+	/* @brief The fewest copies and moves that put n elements of the given category into a new tuple.
+	   @param config The value category of the source elements.
+	   @param n The number of elements. */
+	constexpr CopyStats minimum_for(Configuration config, int n = 1) {
+		const bool movable = config == Configuration::non_const_rvalue;
+		return CopyStats{ 0, movable ? 0 : n, movable ? n : 0 };
+	}
+
+	/* @brief Creates a counter, hands it to the builder and clears what building it cost.
+	   @return The argument in the builder's value category. */
+	template <size_t i, Configuration config>
+	decltype(auto) build_counter(Builder<config>& builder) {
+		decltype(auto) arg = builder.build(make_copy_counter<i>());
+		IndexedCopyCounter<i>::reset();
+		return static_cast<decltype(arg)&&>(arg);
+	}
+
+	/* @brief Like build_counter, for a one-element tuple holding the counter. */
+	template <size_t i, Configuration config>
+	decltype(auto) build_tuple_of_counter(Builder<config>& builder) {
+		decltype(auto) arg = builder.build(metakit::make_tuple(make_copy_counter<i>()));
+		IndexedCopyCounter<i>::reset();
+		return static_cast<decltype(arg)&&>(arg);
+	}
+
+	/* @brief Forwards its argument unchanged, so that transform itself is all that is measured. */
+	struct forward_element {
+		template <typename T>
+		constexpr T&& operator()(T&& e) const noexcept {
+			return static_cast<T&&>(e);
+		}
+	};
+
+	/* @brief Filter predicate keeping only IndexedCopyCounter<kept>. */
+	template <size_t kept>
+	struct keeps {
+		template <typename T>
+		struct predicate : bool_constant<is_same_v<T, IndexedCopyCounter<kept>>> {};
+	};
+
+	inline void run_minimal_copy_tests() {
+		testing::TesterWithBuilder<1>::test("minimal_copies/construction", []<Configuration config>(Builder<config> builder) {
+			/**
+			 * @brief The element-wise constructor and make_tuple construct each element exactly once.
+			 */
+			{
+				[[maybe_unused]] metakit::tuple<IndexedCopyCounter<11>> t{ build_counter<11>(builder) };
+				ASSERT_EQ(IndexedCopyCounter<11>::stats, minimum_for(config));
+			}
+			{
+				[[maybe_unused]] auto t = metakit::make_tuple(build_counter<12>(builder));
+				ASSERT_EQ(IndexedCopyCounter<12>::stats, minimum_for(config));
+			}
+			});
+
+		testing::TesterWithBuilder<1>::test("minimal_copies/get", []<Configuration config>(Builder<config> builder) {
+			/**
+			 * @brief get returns a reference in the category of the tuple and touches nothing.
+			 */
+			using counter = IndexedCopyCounter<13>;
+			decltype(auto) t = build_tuple_of_counter<13>(builder);
+			using expected = decltype(testing::Builder<config>{}.build(counter{}));
+
+			ASSERT((is_same_v<decltype(metakit::get<0>(static_cast<decltype(t)&&>(t))), expected>));
+			[[maybe_unused]] decltype(auto) element = metakit::get<0>(static_cast<decltype(t)&&>(t));
+			ASSERT_EQ(counter::stats, minimum_for(config, 0));
+
+			[[maybe_unused]] counter value = metakit::get<0>(static_cast<decltype(t)&&>(t));
+			ASSERT_EQ(counter::stats, minimum_for(config));
+			});
+
+		testing::TesterWithBuilder<1>::test("minimal_copies/transform", []<Configuration config>(Builder<config> builder) {
+			/**
+			 * @brief transform constructs each result element once from what the function returns.
+			 */
+			decltype(auto) t = build_tuple_of_counter<14>(builder);
+			[[maybe_unused]] auto result = metakit::transform(static_cast<decltype(t)&&>(t), forward_element{});
+			ASSERT_EQ(IndexedCopyCounter<14>::stats, minimum_for(config));
+			});
+
+		testing::TesterWithBuilder<1>::test("minimal_copies/filter", []<Configuration config>(Builder<config> builder) {
+			/**
+			 * @brief filter constructs each kept element once and never touches dropped elements.
+			 */
+			decltype(auto) t = builder.build(metakit::make_tuple(make_copy_counter<15>(), 7, make_copy_counter<16>()));
+			IndexedCopyCounter<15>::reset();
+			IndexedCopyCounter<16>::reset();
+
+			[[maybe_unused]] auto result = metakit::filter<keeps<15>::template predicate>(static_cast<decltype(t)&&>(t));
+			ASSERT((is_same_v<decltype(result), metakit::tuple<IndexedCopyCounter<15>>>));
+			ASSERT_EQ(IndexedCopyCounter<15>::stats, minimum_for(config));
+			ASSERT_EQ(IndexedCopyCounter<16>::stats, minimum_for(config, 0));
+			});
+
+		testing::TesterWithBuilder<2>::test("minimal_copies/tuple_cat", []<Configuration config1, Configuration config2>(Builder<config1, config2> builder) {
+			/**
+			 * @brief tuple_cat constructs each element once, in the category of the tuple it comes from.
+			 */
+			auto args = builder.build(metakit::make_tuple(make_copy_counter<17>()), metakit::make_tuple(make_copy_counter<18>()));
+			IndexedCopyCounter<17>::reset();
+			IndexedCopyCounter<18>::reset();
+
+			[[maybe_unused]] auto result = metakit::tuple_cat(std::get<0>(metakit::move(args)), std::get<1>(metakit::move(args)));
+			ASSERT_EQ(IndexedCopyCounter<17>::stats, minimum_for(config1));
+			ASSERT_EQ(IndexedCopyCounter<18>::stats, minimum_for(config2));
+			});
+	}
+} // namespace test::minimal_copies
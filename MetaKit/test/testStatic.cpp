@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "fixed_string.h"
+#include "helper_.h"
+#include "histogram.h"
+#include "instantiate.h"
+#include "metrics.h"
+#include "named_tuple.h"
+#include "parser.h"
+#include "patch.h"
+#include "reflect.h"
+#include "tuple.h"
+#include "type_list.h"
+#include "type_set.h"
+
+/* @brief Compile-time self-tests of the library headers.
+   Everything here is a static_assert, so the checks run when this file is compiled. */
+namespace test::static_checks
+{
+	using namespace metakit;
+
+	/* helper_.h */
+	static_assert(is_same_v<typename if_<(10 > 5), int, bool>::type, int>);
+	static_assert(is_same_v<typename if_<(10 < 5), int, bool>::type, bool>);
+	static_assert(is_same_v<strip_pointer_t<int*>, int>);
+	static_assert(is_same_v<remove_cvref_t<const volatile int&>, int>);
+	static_assert(is_same_v<remove_cv_t<const int*>, const int*>);
+	static_assert(is_integral_v<const unsigned long&> && !is_integral_v<float> && !is_integral_v<int*>);
+	static_assert(is_trivially_copyable_v<int[4]> && !is_trivially_copyable_v<std::string>);
+	static_assert(is_empty_v<type_list<int>> && !is_empty_v<tuple<int>>);
+	static_assert(is_base_of_v<tuple<bool>, tuple<int, bool>> && !is_base_of_v<tuple<int, bool>, tuple<bool>>);
+
+	/* type_list.h */
+	static_assert(empty_v<type_list<>>);
+	static_assert(empty_v<type_list<int, bool>> == false);
+	static_assert(is_same_v<front_t<type_list<int, bool, float>>, int>);
+	static_assert(is_same_v<pop_front_t<type_list<int, bool, float>>, type_list<bool, float>>);
+	static_assert(is_same_v<back_t<type_list<int, bool, float>>, float>);
+	static_assert(is_same_v<back_t<type_list<int, bool>>, bool>);
+	static_assert(is_same_v<push_back_t<type_list<>, int>, type_list<int>>);
+	static_assert(is_same_v<push_back_t<type_list<int, bool>, float>, type_list<int, bool, float>>);
+	static_assert(is_same_v<pop_back_t<type_list<int>>, type_list<>>);
+	static_assert(is_same_v<pop_back_t<type_list<int, bool, float>>, type_list<int, bool>>);
+	static_assert(is_same_v<pop_back_t<type_list<int, bool>>, type_list<int>>);
+	static_assert(length_v<type_list<>> == 0);
+	static_assert(length_v<type_list<int, bool, float>> == 3);
+	static_assert(is_same_v<at_t<type_list<int, bool, float>, 0>, int>);
+	static_assert(is_same_v<at_t<type_list<int, bool, float>, 1>, bool>);
+	static_assert(is_same_v<at_t<type_list<int, bool, float>, 2>, float>);
+	static_assert(any_v<is_integral, type_list<int, double, std::string>>);
+	static_assert(any_v<is_integral, type_list<std::string, double, int>>);
+	static_assert(!any_v<is_integral, type_list<std::string, double, float>>);
+	static_assert(is_same_v<concat_t<type_list<int>, type_list<>, type_list<bool, float>>, type_list<int, bool, float>>);
+	static_assert(index_of_v<bool, type_list<int, bool, float>> == 1);
+	static_assert(index_of_v<char, type_list<int, bool, float>> == 3);
+	static_assert(is_same_v<reverse_t<type_list<>>, type_list<>>);
+	static_assert(is_same_v<reverse_t<type_list<int, bool, float>>, type_list<float, bool, int>>);
+	static_assert(is_same_v<slice_t<type_list<int, bool, float, char>, 1, 3>, type_list<bool, float>>);
+	static_assert(is_same_v<slice_t<type_list<int, bool>, 2, 2>, type_list<>>);
+	static_assert(is_same_v<insert_at_t<type_list<int, float>, 1, bool>, type_list<int, bool, float>>);
+	static_assert(is_same_v<insert_at_t<type_list<int, float>, 2, bool>, type_list<int, float, bool>>);
+	static_assert(is_same_v<erase_at_t<type_list<int, bool, float>, 1>, type_list<int, float>>);
+	static_assert(is_same_v<erase_at_t<type_list<int>, 0>, type_list<>>);
+	static_assert(is_same_v<rotate_t<type_list<int, bool, float>, 1>, type_list<bool, float, int>>);
+	static_assert(is_same_v<rotate_t<type_list<int, bool, float>, 4>, type_list<bool, float, int>>);
+	static_assert(is_same_v<chunk_t<type_list<int, bool, float>, 2>, type_list<type_list<int, bool>, type_list<float>>>);
+	static_assert(is_same_v<chunk_t<type_list<>, 2>, type_list<>>);
+
+	/* fixed_string.h */
+	static_assert(fixed_string{ "px" }.size() == 2);
+	static_assert(fixed_string{ "px" } == fixed_string{ "px" });
+	static_assert(!(fixed_string{ "px" } == fixed_string{ "ts" }));
+
+	/* instantiate.h */
+#define STATIC_CHECK_TYPES(X, arg) X(arg, int) X(arg, double) X(arg, tuple<int>)
+	static_assert(is_same_v<METAKIT_TYPE_LIST(STATIC_CHECK_TYPES), type_list<int, double, tuple<int>>>);
+
+	/* histogram.h */
+	static_assert(histogram_layout<1000, 4>::index_of(15) == 15 && histogram_layout<1000, 4>::index_of(16) == 16);
+	static_assert(histogram_layout<1000, 4>::index_of(32) == 32 && histogram_layout<1000, 4>::index_of(33) == 32);
+	static_assert(histogram_layout<1000, 4>::index_of(5000) == histogram_layout<1000, 4>::bucket_count - 1);
+	static_assert(histogram_layout<1000, 4>::lowest_in(histogram_layout<1000, 4>::index_of(999)) <= 999
+		&& histogram_layout<1000, 4>::highest_in(histogram_layout<1000, 4>::index_of(999)) >= 999);
+	static_assert(histogram_layout<1000, 4>::highest_in(40) + 1 == histogram_layout<1000, 4>::lowest_in(41));
+
+	/* metrics.h */
+	static_assert(metrics<type_list<struct requests, struct errors>>::slot<errors> == 1);
+	static_assert(metrics<type_list<struct requests, struct errors>>::size == 2);
+
+	/* named_tuple.h */
+	static_assert(sizeof(named_tuple<field<"ts", unsigned long long>, field<"px", double>, field<"qty", int>>)
+		== sizeof(tuple<unsigned long long, double, int>));
+	static_assert(named_tuple<field<"ts", unsigned long long>, field<"px", double>>::index_of<"px"> == 1);
+	static_assert(named_tuple<field<"ts", unsigned long long>, field<"px", double>>::names[0] == "ts");
+	static_assert(is_same_v<field_t<"px", named_tuple<field<"ts", unsigned long long>, field<"px", double>>>, double>);
+
+	/* parser.h */
+	static_assert(is_same_v<parser_result_t<decltype(seq(lit("px="), int_<>, skip(int_<>)))>, tuple<int>>);
+	static_assert(is_same_v<parser_result_t<decltype(seq(int_<>, seq(lit(","), int_<long>)))>, tuple<int, long>>);
+	static_assert(is_same_v<parser_result_t<decltype(alt(int_<>, int_<>))>, int>);
+	static_assert(*parse(int_<>, "-2147483648") == -2147483647 - 1);
+	static_assert(!parse(int_<signed char>, "128"));
+	static_assert(*parse(le_<unsigned short>, "\x34\x12") == 0x1234);
+
+	/* patch.h */
+	static_assert(diff(tuple<int, double, char>{ 1, 2.0, 'a' }, tuple<int, double, char>{ 1, 3.0, 'b' }).words[0] == 0b110);
+	static_assert(record_size_v<tuple<long long, char, double>> == 17 && max_patch_size_v<tuple<long long, char, double>> == 18);
+
+	/* reflect.h */
+	struct reflected { int id; double price; std::string name; std::array<char, 4> code; };
+	static_assert(aggregate_field_count_v<reflected> == 4);
+	static_assert(is_same_v<aggregate_fields_t<reflected>, type_list<int, double, std::string, std::array<char, 4>>>);
+	static_assert(aggregate_field_index(&reflected::price) == 1 && aggregate_field_index(&reflected::code) == 3);
+
+	/* type_set.h */
+	static_assert(type_set<type_list<int, bool, float>>::of<int, float>().includes(type_set<type_list<int, bool, float>>::of<float>()));
+	static_assert(!type_set<type_list<int, bool, float>>::of<int>().includes(type_set<type_list<int, bool, float>>::of<bool>()));
+	static_assert((type_set<type_list<int, bool, float>>::of<int, bool>() & type_set<type_list<int, bool, float>>::of<bool, float>()).size() == 1);
+	static_assert(is_same_v<to_type_list_t<type_set<type_list<int, bool, float>>::of<float, int>()>, type_list<int, float>>);
+} // namespace test::static_checks
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Generates translation units holding the explicit instantiations of a type list.
+
+The types are read from an X-macro in a header (see lib/instantiate.h):
+
+    #define KERNEL_TYPES(X, arg) \\
+        X(arg, int)              \\
+        X(arg, double)
+
+and distributed round-robin over --shards files <prefix>_<k>.cpp. Each shard includes the
+header and explicitly instantiates every --template for its share of the types, so the
+shards compile in parallel and every instantiation is compiled exactly once. Shards left
+in --out by an earlier run with more of them are removed.
+
+Usage: instantiation_shards.py --header kernels.h --list KERNEL_TYPES --template kernel
+                               [--template ...] --shards 8 --out build/shards [--prefix name]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+def read_list(header, name):
+    """Returns the types of the X-macro `name` defined in `header`, in order."""
+    with open(header, encoding="utf-8") as f:
+        text = f.read().replace("\\\r\n", " ").replace("\\\n", " ")
+
+    match = re.search(r"^[ \t]*#[ \t]*define[ \t]+" + re.escape(name) + r"\((\w+),\s*(\w+)\)(.*)$", text, re.M)
+    if not match:
+        sys.exit(f"{header}: no X-macro named {name}")
+    callback, arg, body = match.groups()
+
+    types = []
+    pos = 0
+    prefix = re.compile(r"\b" + re.escape(callback) + r"\s*\(\s*" + re.escape(arg) + r"\s*,")
+    while (m := prefix.search(body, pos)):
+        depth, i = 1, m.end()
+        while depth:
+            if i == len(body):
+                sys.exit(f"{header}: unbalanced parentheses in {name}")
+            depth += {"(": 1, ")": -1}.get(body[i], 0)
+            i += 1
+        types.append(body[m.end():i - 1].strip())
+        pos = i
+    return types
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--header", required=True, help="header defining the X-macro and the templates")
+    parser.add_argument("--list", required=True, help="name of the X-macro listing the types")
+    parser.add_argument("--template", action="append", required=True, help="class template to instantiate")
+    parser.add_argument("--shards", type=int, required=True, help="number of translation units to emit")
+    parser.add_argument("--out", required=True, help="output directory")
+    parser.add_argument("--prefix", default="instantiations", help="file name prefix of the shards")
+    args = parser.parse_args()
+
+    if args.shards < 1:
+        sys.exit("--shards must be positive")
+
+    types = read_list(args.header, args.list)
+    os.makedirs(args.out, exist_ok=True)
+    include = os.path.relpath(os.path.abspath(args.header), os.path.abspath(args.out)).replace(os.sep, "/")
+
+    for k in range(args.shards):
+        lines = [
+            f"// Generated by instantiation_shards.py from {args.list}: shard {k + 1} of {args.shards}.",
+            "// Do not edit.",
+            "",
+            f'#include "{include}"',
+            "",
+        ]
+        for t in types[k::args.shards]:
+            lines += [f"template struct {tmpl}<{t}>;" for tmpl in args.template]
+
+        path = os.path.join(args.out, f"{args.prefix}_{k}.cpp")
+        content = "\n".join(lines) + "\n"
+        # Leave up-to-date shards untouched so that the build does not recompile them.
+        if os.path.exists(path):
+            with open(path, encoding="utf-8") as f:
+                if f.read() == content:
+                    continue
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(content)
+
+    # Remove the shards of an earlier, larger --shards, which would instantiate their types twice.
+    stale = re.compile(re.escape(args.prefix) + r"_(\d+)\.cpp")
+    for name in os.listdir(args.out):
+        m = stale.fullmatch(name)
+        if m and int(m.group(1)) >= args.shards:
+            os.remove(os.path.join(args.out, name))
+
+
+if __name__ == "__main__":
+    main()